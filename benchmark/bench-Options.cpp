@@ -0,0 +1,97 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "bench-Outputs.h"
+#include "../src/Settings.h"
+#include "../test/test-allocations.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// the binary run by Options_exec, which may be overridden to compare another build
+#define BENCH_BINARY_ENV "XLAYOUTDISPLAY_BENCH_BINARY"
+#define BENCH_BINARY_DEFAULT "./xlayoutdisplay"
+
+// the parsing at a typical session startup: command line and ~/.xlayoutdisplay
+static const char *ARGV[] = {"xlayoutdisplay", "-p", "DP-0", "-o", "HDMI-0", "-o", "DP-*", "--timings"};
+static const int ARGC = sizeof(ARGV) / sizeof(ARGV[0]);
+static const char *FILE_TEXT = "# all options here will be overridden by command line options\n"
+                               "mirror=true\n"
+                               "order=DP-1\n"
+                               "settle=250\n"
+                               "quiet=true\n"
+                               "dpi=192\n";
+
+// parsing alone, in process
+static void Options_startup(benchmark::State &state) {
+    size_t allocated = 0;
+    for (auto _ : state) {
+        istringstream file(FILE_TEXT);
+        const size_t before = allocations();
+        Options options = settingsOptions();
+        options.parse(ARGC, ARGV);
+        options.parse(file);
+        const Settings settings(options);
+        allocated += allocations() - before;
+        benchmark::DoNotOptimize(settings.dpi);
+    }
+    state.counters["allocations"] = benchmark::Counter((double) allocated, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(Options_startup);
+
+// exec to exit of the binary performing a trial run of a one output snapshot, needing no X server: loading, option
+// parsing, reading the snapshot and a layout
+static void Options_exec(benchmark::State &state) {
+    const char *binary = getenv(BENCH_BINARY_ENV) ? getenv(BENCH_BINARY_ENV) : BENCH_BINARY_DEFAULT;
+    char snapshotPath[] = "/tmp/xlayoutdisplay-bench.XXXXXX";
+    const int fd = mkstemp(snapshotPath);
+    if (fd < 0) {
+        state.SkipWithError("unable to create snapshot");
+        return;
+    }
+    close(fd);
+    ofstream(snapshotPath) << syntheticSnapshot(1, 10);
+    const char *argv[] = {binary, "--snapshot", snapshotPath, "--noop", "--quiet", nullptr};
+    const int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    for (auto _ : state) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+            execv(binary, const_cast<char *const *>(argv));
+            _exit(127);
+        }
+        int status = -1;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            state.SkipWithError((string("unable to run ") + binary).c_str());
+            break;
+        }
+    }
+
+    close(devNull);
+    remove(snapshotPath);
+}
+BENCHMARK(Options_exec)->Unit(benchmark::kMillisecond);
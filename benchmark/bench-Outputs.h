@@ -0,0 +1,98 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_BENCH_OUTPUTS_H
+#define XLAYOUTDISPLAY_BENCH_OUTPUTS_H
+
+#include <gmock/gmock.h>
+
+#include "../src/Output.h"
+#include "../test/test-MockEdid.h"
+#include "../test/test-MockMonitors.h"
+
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// nmode modes shared by all outputs, ascending resolution in 60, 75 and 144Hz
+inline const std::list<std::shared_ptr<const Mode>> syntheticModes(const long &nmode) {
+    const unsigned int refreshes[] = {60, 75, 144};
+    std::list<std::shared_ptr<const Mode>> modes;
+    for (long i = 0; i < nmode; i++)
+        modes.push_back(std::make_shared<Mode>((RRMode) i + 1, 640 + 16 * (unsigned int) (i / 3),
+                                               480 + 9 * (unsigned int) (i / 3), refreshes[i % 3]));
+    return modes;
+}
+
+// noutput outputs with nmode modes each and a CRTC of their own, every third active; all have EDID and none are laptops
+inline const std::list<std::shared_ptr<Output>> syntheticOutputs(const long &noutput, const long &nmode) {
+    const std::list<std::shared_ptr<const Mode>> modes = syntheticModes(nmode);
+    std::list<std::shared_ptr<Output>> outputs;
+    for (long i = 0; i < noutput; i++) {
+        std::shared_ptr<::testing::NiceMock<MockEdid>> edid = std::make_shared<::testing::NiceMock<MockEdid>>();
+        ON_CALL(*edid, maxCmHoriz()).WillByDefault(::testing::Return(60));
+        ON_CALL(*edid, maxCmVert()).WillByDefault(::testing::Return(34));
+        ON_CALL(*edid, dpiForMode(::testing::_)).WillByDefault(::testing::Return(96));
+
+        const bool active = i % 3 == 0;
+        const std::shared_ptr<Output> output = std::make_shared<Output>(
+                "DP-" + std::to_string(i), active ? Output::active : Output::connected, modes,
+                active ? modes.front() : nullptr, modes.back(), active ? std::make_shared<Pos>(0, 0) : nullptr, edid);
+        output->rrOutput = (RROutput) i + 1;
+        output->crtcs = {(RRCrtc) i + 1};
+        outputs.push_back(output);
+    }
+    return outputs;
+}
+
+// noutput connected outputs with nmode modes each, preferring the smallest so that all fit the screen
+// the first is active and primary, all are able to use any of noutput CRTCs
+inline const std::string syntheticSnapshot(const long &noutput, const long &nmode) {
+    std::stringstream snapshot;
+    snapshot << "lid open\n";
+    snapshot << "screen 320 240 8 8 32767 32767\n";
+    snapshot << "primary 1001\n";
+    for (long i = 0; i < nmode; i++)
+        snapshot << "mode " << 1 + i << ' ' << 320 + 16 * (i / 3) << ' ' << 240 + 9 * (i / 3) << " 148500000 0 0 "
+                 << 2200 - 100 * (i % 3) << " 0 0 0 1125 5\n";
+    std::stringstream crtcIds, modeIds;
+    crtcIds << noutput;
+    for (long i = 0; i < noutput; i++)
+        crtcIds << ' ' << 2001 + i;
+    modeIds << nmode;
+    for (long i = 0; i < nmode; i++)
+        modeIds << ' ' << 1 + i;
+    for (long i = 0; i < noutput; i++) {
+        snapshot << "crtc " << 2001 + i;
+        if (i == 0)
+            snapshot << " 0 0 320 240 1 1 15 1 1001 ";
+        else
+            snapshot << " 0 0 0 0 0 1 15 0 ";
+        snapshot << noutput;
+        for (long j = 0; j < noutput; j++)
+            snapshot << ' ' << 1001 + j;
+        snapshot << '\n';
+    }
+    for (long i = 0; i < noutput; i++)
+        snapshot << "output " << 1001 + i << " DP-" << i << " 0 " << (i == 0 ? 2001 : 0) << " 600 340 1 "
+                 << crtcIds.str() << " 0 " << modeIds.str() << '\n';
+    return snapshot.str();
+}
+
+// noutput from 1 to 64 and nmode from 10 to 500
+#define BENCHMARK_OUTPUTS(b) BENCHMARK(b)->ArgsProduct({{1, 8, 64}, {10, 100, 500}})->ArgNames({"outputs", "modes"})
+
+#endif //XLAYOUTDISPLAY_BENCH_OUTPUTS_H
@@ -0,0 +1,100 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "bench-Outputs.h"
+#include "../src/calculations.h"
+#include "../test/test-allocations.h"
+
+using namespace std;
+
+static void calculations_calculateOptimalMode(benchmark::State &state) {
+    const ModeTable modes(syntheticModes(state.range(1)));
+    const shared_ptr<const Mode> preferred = *next(modes.begin(), (long) modes.size() / 2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateOptimalMode(modes, preferred));
+}
+BENCHMARK_OUTPUTS(calculations_calculateOptimalMode);
+
+static void calculations_orderOutputs(benchmark::State &state) {
+    list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    const OutputOrder order({"DP-" + to_string(state.range(0) - 1), "HDMI-0", "dp-0", "DP-1*"});
+    for (auto _ : state)
+        orderOutputs(outputs, order);
+}
+BENCHMARK_OUTPUTS(calculations_orderOutputs);
+
+static void calculations_activateOutputs(benchmark::State &state) {
+    const list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    const ::testing::NiceMock<MockMonitors> monitors;
+    const string primary = "DP-" + to_string(state.range(0) - 1);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(activateOutputs(outputs, primary, monitors));
+}
+BENCHMARK_OUTPUTS(calculations_activateOutputs);
+
+static void calculations_ltrOutputs(benchmark::State &state) {
+    const list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    activateOutputs(outputs, string(), ::testing::NiceMock<MockMonitors>());
+    for (auto _ : state)
+        ltrOutputs(outputs);
+}
+BENCHMARK_OUTPUTS(calculations_ltrOutputs);
+
+static void calculations_mirrorOutputs(benchmark::State &state) {
+    const list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    activateOutputs(outputs, string(), ::testing::NiceMock<MockMonitors>());
+    for (auto _ : state)
+        mirrorOutputs(outputs);
+}
+BENCHMARK_OUTPUTS(calculations_mirrorOutputs);
+
+// only the lower half of the first output's resolutions are common, so that many are rejected
+static void calculations_mirrorOutputsHalfCommon(benchmark::State &state) {
+    list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), (state.range(1) + 1) / 2);
+    outputs.front() = syntheticOutputs(1, state.range(1)).front();
+    activateOutputs(outputs, string(), ::testing::NiceMock<MockMonitors>());
+    for (auto _ : state)
+        mirrorOutputs(outputs);
+}
+BENCHMARK_OUTPUTS(calculations_mirrorOutputsHalfCommon);
+
+static void calculations_renderUserInfo(benchmark::State &state) {
+    const list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(renderUserInfo(outputs));
+}
+BENCHMARK_OUTPUTS(calculations_renderUserInfo);
+
+// a whole left to right layout, reporting heap allocations per pass, which do not grow with outputs
+static void calculations_layoutPass(benchmark::State &state) {
+    list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    const Monitors monitors(true);
+    const OutputOrder order({"DP-" + to_string(state.range(0) - 1)});
+    size_t allocated = 0;
+    for (auto _ : state) {
+        const size_t before = allocations();
+        for (const auto &output : outputs)
+            output->resetDesired();
+        orderOutputs(outputs, order);
+        activateOutputs(outputs, string(), monitors);
+        ltrOutputs(outputs);
+        assignCrtcs(outputs);
+        allocated += allocations() - before;
+    }
+    state.counters["allocations"] = benchmark::Counter((double) allocated, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_OUTPUTS(calculations_layoutPass);
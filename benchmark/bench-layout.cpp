@@ -0,0 +1,42 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "bench-Outputs.h"
+#include "../src/layout.h"
+#include "../src/SnapshotBackend.h"
+
+#include <sstream>
+
+using namespace std;
+
+// discover, lay out and apply a snapshot end to end, quietly and without the cache
+static void layout_replay(benchmark::State &state) {
+    const string snapshot = syntheticSnapshot(state.range(0), state.range(1));
+    Options options = settingsOptions();
+    const char *argv[] = {"xlayoutdisplay", "--quiet", "--nocache"};
+    options.parse(3, argv);
+    const Settings settings(options);
+    Timings timings(settings.timings);
+    for (auto _ : state) {
+        istringstream in(snapshot);
+        SnapshotBackend backend(in);
+        string discoveryExplaination;
+        const list<shared_ptr<Output>> outputs = backend.discover(false, &discoveryExplaination);
+        benchmark::DoNotOptimize(layout(settings, backend, outputs, discoveryExplaination, timings));
+    }
+}
+BENCHMARK(layout_replay)->ArgsProduct({{1, 8, 64}, {10, 100, 500}})->ArgNames({"outputs", "modes"});
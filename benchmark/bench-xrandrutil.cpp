@@ -0,0 +1,107 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "bench-Outputs.h"
+#include "../src/calculations.h"
+#include "../src/xrandrrutil.h"
+#include "../test/test-allocations.h"
+
+#include <vector>
+
+using namespace std;
+
+static void xrandrutil_renderXrandrCmd(benchmark::State &state) {
+    const list<shared_ptr<Output>> outputs = syntheticOutputs(state.range(0), state.range(1));
+    const shared_ptr<Output> primary = activateOutputs(outputs, string(), ::testing::NiceMock<MockMonitors>());
+    ltrOutputs(outputs);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(renderXrandrCmd(outputs, primary, 96, 0));
+}
+BENCHMARK_OUTPUTS(xrandrutil_renderXrandrCmd);
+
+// resources with nmode modes, ids from 1
+class SyntheticResources {
+public:
+    explicit SyntheticResources(const long &nmode) : modeInfos((size_t) nmode) {
+        for (long i = 0; i < nmode; i++) {
+            XRRModeInfo &modeInfo = modeInfos[(size_t) i];
+            modeInfo.id = (RRMode) i + 1;
+            modeInfo.width = 640 + 16 * (unsigned int) i;
+            modeInfo.height = 480 + 9 * (unsigned int) i;
+            modeInfo.dotClock = 148500000;
+            modeInfo.hTotal = 2200;
+            modeInfo.vTotal = 1125;
+        }
+        resources.nmode = (int) nmode;
+        resources.modes = modeInfos.data();
+    }
+
+    vector<XRRModeInfo> modeInfos;
+    XRRScreenResources resources{};
+};
+
+static void xrandrutil_modeFromXRR(benchmark::State &state) {
+    const SyntheticResources synthetic(state.range(0));
+
+    // the last is the worst case
+    for (auto _ : state)
+        delete modeFromXRR((RRMode) state.range(0), &synthetic.resources);
+}
+BENCHMARK(xrandrutil_modeFromXRR)->Arg(10)->Arg(100)->Arg(500)->ArgName("modes");
+
+// all outputs of a discovery sharing every mode, reporting heap allocations made by the index and per output
+// Modes are made once in the index's arena, so allocations per output should not grow with modes
+static void xrandrutil_outputFromXRR(benchmark::State &state) {
+    const SyntheticResources synthetic(state.range(1));
+    vector<RRMode> rrModes;
+    for (const auto &modeInfo : synthetic.modeInfos)
+        rrModes.push_back(modeInfo.id);
+    char name[] = "DP";
+    XRROutputInfo outputInfo{};
+    outputInfo.name = name;
+    outputInfo.nameLen = 2;
+    outputInfo.nmode = (int) rrModes.size();
+    outputInfo.modes = rrModes.data();
+    outputInfo.npreferred = 1;
+
+    size_t indexAllocated = 0, outputsAllocated = 0;
+    for (auto _ : state) {
+        const size_t before = allocations();
+        ModeIndex modeIndex(&synthetic.resources);
+        const size_t indexed = allocations();
+        for (long i = 0; i < state.range(0); i++) {
+            benchmark::DoNotOptimize(
+                    outputFromXRR(modeIndex, (RROutput) i + 1, &outputInfo, nullptr, Lazy<const Edid>()));
+        }
+        indexAllocated += indexed - before;
+        outputsAllocated += allocations() - indexed;
+    }
+    state.counters["indexAllocations"] =
+            benchmark::Counter((double) indexAllocated, benchmark::Counter::kAvgIterations);
+    state.counters["allocationsPerOutput"] =
+            benchmark::Counter((double) outputsAllocated / (double) state.range(0), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_OUTPUTS(xrandrutil_outputFromXRR);
+
+static void xrandrutil_refreshFromModeInfo(benchmark::State &state) {
+    const SyntheticResources synthetic(1);
+    XRRModeInfo modeInfo = synthetic.modeInfos.front();
+    modeInfo.modeFlags = RR_DoubleScan;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(refreshFromModeInfo(modeInfo));
+}
+BENCHMARK(xrandrutil_refreshFromModeInfo);
@@ -13,14 +13,6 @@
    See the License for the specific language governing permissions and
    limitations under the License.
 */
-#include "Mode.h"
+#include <benchmark/benchmark.h>
 
-bool Mode::operator<(const Mode &o) const {
-    if (width == o.width)
-        if (height == o.height)
-            return refresh < o.refresh;
-        else
-            return height < o.height;
-    else
-        return width < o.width;
-}
+BENCHMARK_MAIN();
@@ -7,10 +7,11 @@ INCS =
 
 CPPFLAGS = $(INCS) -DVERSION=\"$(VERSION)\"
 
-CXXFLAGS = -pedantic -Wall -Wextra -Werror -O3 -std=c++14
+CXXFLAGS = -pedantic -Wall -Wextra -Werror -O3 -std=c++14 -pthread
 
-LDFLAGS = -lX11 -lXcursor -lXrandr -lboost_program_options
+LDFLAGS = -lX11 -lX11-xcb -lxcb -lxcb-randr -lXcursor -lXrandr -pthread
 LDFLAGS_TEST = -lgmock -lgtest -pthread
+LDFLAGS_BENCH = -lbenchmark -lgmock -lgtest -pthread
 
 CXX = g++
 
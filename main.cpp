@@ -18,76 +18,69 @@
 #include <exception>
 #include <iostream>
 #include <fstream>
-#include <boost/program_options.hpp>
 
+#include "src/daemon.h"
+#include "src/fleet.h"
 #include "src/layout.h"
+#include "src/SnapshotBackend.h"
 #include "src/util.h"
 
 using namespace std;
-namespace po = boost::program_options;
 
 int main(int argc, const char **argv) {
     try {
-        po::variables_map vm;
-
-        // common options
-        po::options_description options("CLI, /etc/xlayoutdisplay and ~/.xlayoutdisplay");
-        options.add_options()
-                ("dpi,d", po::value<long>(), "DPI override")
-                ("rate,r", po::value<long>(), "Refresh rate override")
-                ("mirror,m", "mirror outputs using the lowest common resolution")
-                ("order,o", po::value<vector<string>>(), "order of outputs, repeat as needed")
-                ("primary,p", po::value<string>(), "primary output")
-                ("quiet,q", "suppress feedback");
-
-        // file options
-        po::options_description fileOptions("/etc/xlayoutdisplay and ~/.xlayoutdisplay");
-        fileOptions.add(options);
-
-        // command line options
-        po::options_description cliOptions("CLI");
-        cliOptions.add_options()
-                ("help,h", "print this help text and exit")
-                ("info,i", "print information about current outputs and exit")
-                ("noop,n", "perform a trial run and exit")
-                ("version,v", "print version string");
-        cliOptions.add(options);
+        Options options = settingsOptions();
 
         // command line options take precedence
-        po::store(po::command_line_parser(argc, argv).options(cliOptions).run(), vm);
-        po::notify(vm);
+        options.parse(argc, argv);
 
         // file options afterwards
         ifstream ifs(resolveTildePath(".xlayoutdisplay"));
         if (!ifs)
             ifs = ifstream("/etc/xlayoutdisplay");
-        if (ifs) {
-            po::store(parse_config_file(ifs, fileOptions), vm);
-            po::notify(vm);
-        }
+        if (ifs)
+            options.parse(ifs);
 
         // usage
-        if (vm.count("help")) {
+        if (options.count("help")) {
             cout << "Arranges outputs in a left to right manner, using highest resolution and refresh.\n"
                     "DPI is calculated based on the first or primary output's EDID information and rounded to the nearest 12.\n"
                     "Laptop outputs are turned off when the lid is closed.\n"
                     "\n"
                     "e.g.  xlayoutdisplay -p DP-4 -o HDMI-0 -o DP-4\n"
                     "\n";
-            cout << cliOptions;
+            cout << options;
             return EXIT_SUCCESS;
         }
 
         // version
-        if (vm.count("version")) {
+        if (options.count("version")) {
             cout << argv[0] << " " << VERSION << endl;
             return EXIT_SUCCESS;
         }
 
         // render settings
-        const Settings settings(vm);
+        const Settings settings(options);
 
         // execute
+        if (!settings.record.empty()) {
+            recordSnapshot(settings.record, settings.probe);
+            if (!settings.quiet)
+                cout << "recorded snapshot " << settings.record << "\n";
+            return EXIT_SUCCESS;
+        }
+        if (!settings.scaledMirror.empty() && settings.scaledMirror != "primary" && settings.scaledMirror != "largest")
+            throw invalid_argument("--scaled-mirror must be primary or largest, not '" + settings.scaledMirror + "'");
+        if (settings.daemon && !settings.snapshot.empty())
+            throw invalid_argument("--daemon cannot be used with --snapshot");
+        if (settings.displays.size() > 1 && !settings.fleet)
+            throw invalid_argument("more than one --display requires --fleet");
+        if (settings.fleet && (settings.daemon || !settings.snapshot.empty() || settings.xrandr || settings.xrdb))
+            throw invalid_argument("--fleet cannot be used with --daemon, --snapshot, --xrandr or --xrdb");
+        if (settings.fleet)
+            return runFleet(settings);
+        if (settings.daemon)
+            return WEXITSTATUS(runDaemon(settings));
         return WEXITSTATUS(layout(settings));
     } catch (const exception &e) {
         cerr << argv[0] << ": " << e.what() << ", exiting\n";
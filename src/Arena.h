@@ -0,0 +1,52 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_ARENA_H
+#define XLAYOUTDISPLAY_ARENA_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// values of a single run, held contiguously in one block that is released once no pointer into it remains
+// pointers share the arena's reference count, so that making a value costs no allocation
+template<typename T>
+class Arena {
+public:
+    // room for capacity values
+    explicit Arena(const size_t &capacity) : values(std::make_shared<std::vector<T>>()) {
+        values->reserve(capacity);
+    }
+
+    // construct a value in place
+    // throws length_error:
+    //   capacity reached, as growing would move values already pointed to
+    template<typename... Args>
+    std::shared_ptr<T> make(Args &&... args) {
+        if (values->size() == values->capacity())
+            throw std::length_error("Arena full at " + std::to_string(values->capacity()) + " values");
+        values->emplace_back(std::forward<Args>(args)...);
+        return std::shared_ptr<T>(values, &values->back());
+    }
+
+    size_t size() const { return values->size(); }
+
+private:
+    const std::shared_ptr<std::vector<T>> values;
+};
+
+#endif //XLAYOUTDISPLAY_ARENA_H
@@ -0,0 +1,89 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Atoms.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+Atoms::~Atoms() {
+    discard();
+}
+
+void Atoms::discard() {
+    for (const auto &pending : pendingAtoms)
+        xcb_discard_reply(conn, pending.second.sequence);
+    pendingAtoms.clear();
+}
+
+void Atoms::request(const vector<string> &names) {
+    for (const auto &name : names) {
+        if (internedAtoms.count(name) || pendingAtoms.count(name))
+            continue;
+        pendingAtoms[name] = traffic.sent(xcb_intern_atom(conn, 1, (uint16_t) name.size(), name.c_str()));
+    }
+}
+
+xcb_atom_t Atoms::atom(const string &name) {
+    const auto interned = internedAtoms.find(name);
+    if (interned != internedAtoms.end())
+        return interned->second;
+
+    request({name});
+    const auto pending = pendingAtoms.find(name);
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(conn, traffic.awaiting(pending->second), nullptr);
+    pendingAtoms.erase(pending);
+
+    xcb_atom_t atom = XCB_ATOM_NONE;
+    if (reply) {
+        atom = reply->atom;
+        free(reply);
+    }
+
+    // remember only those that exist
+    if (atom != XCB_ATOM_NONE) {
+        internedAtoms[name] = atom;
+        atomNames[atom] = name;
+    }
+    return atom;
+}
+
+const vector<string> Atoms::names(const vector<xcb_atom_t> &atoms) {
+
+    // send all unknown
+    map<xcb_atom_t, xcb_get_atom_name_cookie_t> cookies;
+    for (const auto &atom : atoms)
+        if (!atomNames.count(atom) && !cookies.count(atom))
+            cookies[atom] = traffic.sent(xcb_get_atom_name(conn, atom));
+
+    // collect
+    for (const auto &cookie : cookies) {
+        xcb_get_atom_name_reply_t *reply = xcb_get_atom_name_reply(conn, traffic.awaiting(cookie.second), nullptr);
+        if (reply) {
+            const string name(xcb_get_atom_name_name(reply), (size_t) xcb_get_atom_name_name_length(reply));
+            atomNames[cookie.first] = name;
+            internedAtoms[name] = cookie.first;
+            free(reply);
+        }
+    }
+
+    vector<string> names;
+    for (const auto &atom : atoms) {
+        const auto name = atomNames.find(atom);
+        names.push_back(name == atomNames.end() ? string() : name->second);
+    }
+    return names;
+}
@@ -0,0 +1,62 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_ATOMS_H
+#define XLAYOUTDISPLAY_ATOMS_H
+
+#include "XTraffic.h"
+
+#include <xcb/xcb.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// atoms interned for a single X connection, shared by everything that reads properties
+// atoms are only looked up, never created; those that do not exist are looked up again on next use, as they may be
+// created later e.g. EDID when the first monitor is plugged in
+class Atoms {
+public:
+    Atoms(xcb_connection_t *conn, XTraffic &traffic) : conn(conn), traffic(traffic) {}
+
+    Atoms(const Atoms &) = delete;
+
+    Atoms &operator=(const Atoms &) = delete;
+
+    // the connection must still be open
+    ~Atoms();
+
+    // discard replies to lookups that have been sent but not yet collected
+    void discard();
+
+    // send lookups for names not yet known, without waiting, so that they may be resolved along with other requests
+    void request(const std::vector<std::string> &names);
+
+    // XCB_ATOM_NONE if name does not exist; waits for the reply if not yet known
+    xcb_atom_t atom(const std::string &name);
+
+    // names of atoms; lookups for all unknown atoms are sent before waiting
+    const std::vector<std::string> names(const std::vector<xcb_atom_t> &atoms);
+
+private:
+    xcb_connection_t *conn;
+    XTraffic &traffic;
+
+    std::map<std::string, xcb_atom_t> internedAtoms;
+    std::map<std::string, xcb_intern_atom_cookie_t> pendingAtoms;
+    std::map<xcb_atom_t, std::string> atomNames;
+};
+
+#endif //XLAYOUTDISPLAY_ATOMS_H
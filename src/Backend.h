@@ -0,0 +1,63 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_BACKEND_H
+#define XLAYOUTDISPLAY_BACKEND_H
+
+#include "Output.h"
+#include "XTraffic.h"
+
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+
+// the display server as seen by layout: discovery, apply, DPI resources and cursor
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    // build a list of Output based on the current and possible state of the world, as per discoverOutputs
+    virtual const std::list<std::shared_ptr<Output>> discover(const bool &probe, std::string *explaination) = 0;
+
+    // rediscover after changed outputs have changed, reusing the others from previous, as per rediscoverOutputs
+    virtual const std::list<std::shared_ptr<Output>> rediscover(const std::list<std::shared_ptr<Output>> &previous,
+                                                                const std::set<RROutput> &changed,
+                                                                std::string *explaination) = 0;
+
+    // true if the laptop lid is closed
+    virtual bool laptopLidClosed() const = 0;
+
+    // the screen's current size in pixels
+    virtual const std::pair<unsigned int, unsigned int> screenSize() const = 0;
+
+    // the screen's current physical size in millimetres
+    virtual const std::pair<unsigned int, unsigned int> screenMm() const = 0;
+
+    // apply the desired state of outputs, as per applyOutputs
+    virtual void apply(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary,
+                       const long &dpi, const long &rate) = 0;
+
+    // set "Xft.dpi", as per applyXftDpi; returns true if it changed
+    virtual bool applyXftDpi(const long &dpi) = 0;
+
+    // reset the root window's cursor, as per resetRootCursor
+    virtual void resetRootCursor() = 0;
+
+    // X traffic so far
+    virtual XTraffic::Counts traffic() const = 0;
+};
+
+#endif //XLAYOUTDISPLAY_BACKEND_H
@@ -14,6 +14,7 @@
    limitations under the License.
 */
 #include "Edid.h"
+#include "util.h"
 
 #include <cstring>
 #include <cmath>
@@ -23,25 +24,32 @@ using namespace std;
 
 #define INCHES_PER_CM   2.54    // apparently this is exact
 
-Edid::Edid(const unsigned char *edid, const size_t length, const char *name) {
+Edid::Edid(const shared_ptr<const unsigned char> &edid, const size_t length, const char *name) :
+        length(length),
+        edid(edid) {
     if (length < EDID_MIN_LENGTH)
         throw invalid_argument(string(name) + " has Edid size " + to_string(length) + ", expected at least " +
                                to_string(EDID_MIN_LENGTH));
+}
 
-    this->edid = (unsigned char *) malloc(length);
-    memcpy(this->edid, edid, length);
+Edid::Edid(const unsigned char *edid, const size_t length, const char *name) :
+        Edid(copy(edid, length), length, name) {
 }
 
-Edid::~Edid() {
-    free(edid);
+Edid::~Edid() = default;
+
+shared_ptr<const unsigned char> Edid::copy(const unsigned char *edid, const size_t length) {
+    shared_ptr<unsigned char> copied(new unsigned char[length], default_delete<unsigned char[]>());
+    memcpy(copied.get(), edid, length);
+    return copied;
 }
 
 unsigned int Edid::maxCmHoriz() const {
-    return edid[EDID_BYTE_MAX_CM_HORIZ];
+    return edid.get()[EDID_BYTE_MAX_CM_HORIZ];
 }
 
 unsigned int Edid::maxCmVert() const {
-    return edid[EDID_BYTE_MAX_CM_VERT];
+    return edid.get()[EDID_BYTE_MAX_CM_VERT];
 }
 
 long Edid::dpiForMode(const std::shared_ptr<const Mode> &mode) const {
@@ -55,3 +63,10 @@ long Edid::dpiForMode(const std::shared_ptr<const Mode> &mode) const {
     return lround((dpiHoriz + dpiVert) / 24) * 12;
 }
 
+uint64_t Edid::fingerprint() const {
+    if (!fingerprintDecoded) {
+        fingerprintValue = fnv1a(edid.get() + EDID_BYTE_ID_START, EDID_BYTE_ID_END - EDID_BYTE_ID_START);
+        fingerprintDecoded = true;
+    }
+    return fingerprintValue;
+}
@@ -16,16 +16,27 @@
 #ifndef XLAYOUTDISPLAY_EDID_H
 #define XLAYOUTDISPLAY_EDID_H
 
+#include <cstdint>
 #include <memory>
 #include "Mode.h"
 
 #define EDID_MIN_LENGTH 128
+#define EDID_BLOCK_LENGTH 128
+#define EDID_BYTE_ID_START 0x08 // manufacturer, product code and serial number
+#define EDID_BYTE_ID_END 0x10
 #define EDID_BYTE_MAX_CM_HORIZ 0x15
 #define EDID_BYTE_MAX_CM_VERT 0x16
+#define EDID_BYTE_EXTENSIONS 0x7E
 
+// a view over raw EDID, shared rather than copied; the fingerprint is calculated when first asked for
 class Edid {
 public:
-    // we only need the first 128 bytes of EDID - the basic structure
+    // view edid without copying, sharing ownership with the caller
+    // throws invalid_argument:
+    //   when length < EDID_MIN_LENGTH
+    Edid(const std::shared_ptr<const unsigned char> &edid, size_t length, const char *name);
+
+    // copies edid
     // throws invalid_argument:
     //   when length < EDID_MIN_LENGTH
     Edid(const unsigned char *edid, size_t length, const char *name);
@@ -39,8 +50,21 @@ public:
     // nearest 12
     virtual long dpiForMode(const std::shared_ptr<const Mode> &mode) const;
 
+    // hash of manufacturer, product code and serial number, identifying a monitor
+    virtual uint64_t fingerprint() const;
+
+    // raw EDID of length
+    const unsigned char *data() const { return edid.get(); }
+
+    const size_t length;
+
 private:
-    unsigned char *edid = nullptr;
+    static std::shared_ptr<const unsigned char> copy(const unsigned char *edid, size_t length);
+
+    const std::shared_ptr<const unsigned char> edid;
+
+    mutable bool fingerprintDecoded = false;
+    mutable uint64_t fingerprintValue = 0;
 };
 
 #endif //XLAYOUTDISPLAY_EDID_H
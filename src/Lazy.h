@@ -0,0 +1,82 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_LAZY_H
+#define XLAYOUTDISPLAY_LAZY_H
+
+#include <exception>
+#include <functional>
+#include <memory>
+
+// a shared value that is loaded on first use then retained
+// loading may be split into request and load, so that many values may be requested before any are waited for
+template<typename T>
+class Lazy {
+public:
+    // empty
+    Lazy() = default;
+
+    // already loaded
+    template<typename U>
+    Lazy(const std::shared_ptr<U> &value) : value(value) {}
+
+    // request is called at most once, before load
+    Lazy(const std::function<void()> &request, const std::function<std::shared_ptr<T>()> &load) :
+            requester(request), loader(load) {}
+
+    // start loading without waiting for the value; no effect when already loaded
+    void request() const {
+        if (requester) {
+            const std::function<void()> requesting = requester;
+            requester = nullptr;
+            requesting();
+        }
+    }
+
+    // load if needed
+    // a load that throws is not attempted again; its exception is thrown by this and every later get
+    const std::shared_ptr<T> &get() const {
+        if (loader) {
+            request();
+            const std::function<std::shared_ptr<T>()> loading = loader;
+            loader = nullptr;
+            try {
+                value = loading();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+        return value;
+    }
+
+    T *operator->() const { return get().get(); }
+
+    T &operator*() const { return *get(); }
+
+    explicit operator bool() const { return (bool) get(); }
+
+    // true if get() will not load
+    bool loaded() const { return !loader; }
+
+private:
+    mutable std::function<void()> requester;
+    mutable std::function<std::shared_ptr<T>()> loader;
+    mutable std::shared_ptr<T> value;
+    mutable std::exception_ptr error;
+};
+
+#endif //XLAYOUTDISPLAY_LAZY_H
@@ -18,9 +18,15 @@
 
 #include <X11/extensions/Xrandr.h>
 
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
 // a mode that may be used by an Xrandr display
 class Mode {
 public:
+    // throws invalid_argument:
+    //   width or height beyond 16 bits, as are RandR's
     Mode(const RRMode &rrMode,
          const unsigned int &width,
          const unsigned int &height,
@@ -28,16 +34,26 @@ public:
             rrMode(rrMode),
             width(width),
             height(height),
-            refresh(refresh) {
+            refresh(refresh),
+            key(sortKey(width, height, refresh)) {
+        if (width > UINT16_MAX || height > UINT16_MAX)
+            throw std::invalid_argument("mode " + std::to_string(width) + "x" + std::to_string(height) +
+                                        " is too large");
+    }
+
+    // width, height and refresh packed so that they order as a single integer
+    static uint64_t sortKey(const unsigned int &width, const unsigned int &height, const unsigned int &refresh) {
+        return (uint64_t) width << 48 | (uint64_t) height << 32 | refresh;
     }
 
     // order by width, height, refresh
-    bool operator<(const Mode &o) const;
+    bool operator<(const Mode &o) const { return key < o.key; }
 
     const RRMode rrMode;
     const unsigned int width;
     const unsigned int height;
     const unsigned int refresh;
+    const uint64_t key;
 };
 
 #endif //XLAYOUTDISPLAY_MODE_H
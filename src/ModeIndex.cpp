@@ -0,0 +1,44 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "ModeIndex.h"
+#include "xrandrrutil.h"
+
+#include <system_error>
+
+using namespace std;
+
+ModeIndex::ModeIndex(const XRRScreenResources *resources) :
+        modes(resources ? (size_t) resources->nmode : 0) {
+    if (resources == nullptr)
+        throw invalid_argument("cannot construct ModeIndex: NULL XRRScreenResources");
+
+    entries.reserve((size_t) resources->nmode);
+    for (int i = 0; i < resources->nmode; i++)
+        entries.emplace(resources->modes[i].id, Entry{&resources->modes[i], nullptr});
+}
+
+const shared_ptr<const Mode> &ModeIndex::mode(const RRMode &id) {
+    const auto entry = entries.find(id);
+    if (entry == entries.end())
+        throw invalid_argument("cannot construct Mode: cannot retrieve RRMode '" + to_string(id) + "'");
+
+    if (!entry->second.mode) {
+        const XRRModeInfo *modeInfo = entry->second.modeInfo;
+        entry->second.mode = modes.make(id, modeInfo->width, modeInfo->height, refreshFromModeInfo(*modeInfo));
+    }
+
+    return entry->second.mode;
+}
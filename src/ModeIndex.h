@@ -0,0 +1,47 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_MODEINDEX_H
+#define XLAYOUTDISPLAY_MODEINDEX_H
+
+#include "Arena.h"
+#include "Mode.h"
+
+#include <memory>
+#include <unordered_map>
+
+// all modes of an XRRScreenResources, indexed by RRMode
+// a single Mode is created for each RRMode on first use and shared by all outputs; all are held in one arena
+class ModeIndex {
+public:
+    // throws invalid_argument:
+    //   null resources
+    explicit ModeIndex(const XRRScreenResources *resources);
+
+    // throws invalid_argument:
+    //   id not found in resources
+    const std::shared_ptr<const Mode> &mode(const RRMode &id);
+
+private:
+    struct Entry {
+        const XRRModeInfo *modeInfo;
+        std::shared_ptr<const Mode> mode;
+    };
+
+    std::unordered_map<RRMode, Entry> entries;
+    Arena<Mode> modes;
+};
+
+#endif //XLAYOUTDISPLAY_MODEINDEX_H
@@ -0,0 +1,63 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "ModeTable.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+static const shared_ptr<const Mode> NO_MODE;
+
+ModeTable::ModeTable(vector<shared_ptr<const Mode>> modes) : sorted(move(modes)) {
+
+    // last listed first, which a stable sort preserves for those that sort equally
+    reverse(sorted.begin(), sorted.end());
+    stable_sort(sorted.begin(), sorted.end(),
+                [](const shared_ptr<const Mode> &l, const shared_ptr<const Mode> &r) { return l->key > r->key; });
+
+    // exact duplicates share a key, so look back only as far as that
+    size_t kept = 0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        bool duplicate = false;
+        for (size_t j = kept; !duplicate && j-- > 0 && sorted[j]->key == sorted[i]->key;)
+            duplicate = sorted[j]->rrMode == sorted[i]->rrMode;
+        if (!duplicate)
+            sorted[kept++] = sorted[i];
+    }
+    sorted.resize(kept);
+
+    keys.reserve(sorted.size());
+    for (const auto &mode : sorted)
+        keys.push_back(mode->key);
+}
+
+const shared_ptr<const Mode> &ModeTable::best(const unsigned int &width, const unsigned int &height) const {
+    const uint64_t highest = Mode::sortKey(width, height, UINT32_MAX);
+    const auto key = lower_bound(keys.begin(), keys.end(), highest, greater<uint64_t>());
+    if (key == keys.end() || *key >> 32 != highest >> 32)
+        return NO_MODE;
+    return sorted[key - keys.begin()];
+}
+
+ModeTable::const_iterator ModeTable::nextResolution(const const_iterator &it) const {
+    size_t i = it - sorted.begin();
+    if (i >= keys.size())
+        return end();
+    const uint64_t resolution = keys[i] >> 32;
+    while (++i < keys.size() && keys[i] >> 32 == resolution);
+    return sorted.begin() + i;
+}
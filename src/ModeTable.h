@@ -0,0 +1,69 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_MODETABLE_H
+#define XLAYOUTDISPLAY_MODETABLE_H
+
+#include "Mode.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+// modes of an output, sorted once, descending, by width, height then refresh, with exact duplicates removed
+// modes that sort equally keep the last listed first
+// sort keys are held contiguously, so that searching touches no Mode
+class ModeTable {
+public:
+    typedef std::vector<std::shared_ptr<const Mode>>::const_iterator const_iterator;
+
+    ModeTable() = default;
+
+    // modes as discovered, in any order
+    ModeTable(std::vector<std::shared_ptr<const Mode>> modes);
+
+    ModeTable(const std::list<std::shared_ptr<const Mode>> &modes) :
+            ModeTable(std::vector<std::shared_ptr<const Mode>>(modes.begin(), modes.end())) {}
+
+    const_iterator begin() const { return sorted.begin(); }
+
+    const_iterator end() const { return sorted.end(); }
+
+    size_t size() const { return sorted.size(); }
+
+    bool empty() const { return sorted.empty(); }
+
+    // highest mode
+    const std::shared_ptr<const Mode> &front() const { return sorted.front(); }
+
+    // lowest mode
+    const std::shared_ptr<const Mode> &back() const { return sorted.back(); }
+
+    // the same modes, in the same order
+    bool operator==(const ModeTable &o) const { return sorted == o.sorted; }
+
+    // highest refresh mode of width and height, nullptr when there is none
+    const std::shared_ptr<const Mode> &best(const unsigned int &width, const unsigned int &height) const;
+
+    // the first mode with a different width or height after it, end() when none
+    const_iterator nextResolution(const const_iterator &it) const;
+
+private:
+    std::vector<std::shared_ptr<const Mode>> sorted;
+    std::vector<uint64_t> keys;
+};
+
+#endif //XLAYOUTDISPLAY_MODETABLE_H
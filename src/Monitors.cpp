@@ -19,8 +19,8 @@
 #include <dirent.h>
 
 bool calculateLaptopLidClosed(const char *laptopLidRootPath) {
-    static char lidFileName[PATH_MAX];
-    static char line[512];
+    char lidFileName[PATH_MAX];
+    char line[512];
 
     // find the lid state directory
     DIR *dir = opendir(laptopLidRootPath);
@@ -31,6 +31,8 @@ class Monitors {
 public:
     Monitors() : laptopLidClosed(calculateLaptopLidClosed(LAPTOP_LID_ROOT_PATH)) {}
 
+    explicit Monitors(const bool &laptopLidClosed) : laptopLidClosed(laptopLidClosed) {}
+
     // return true if the output should be disabled i.e. lid closed and name begins with LAPTOP_OUPUT_PREFIX
     virtual bool shouldDisableOutput(const std::string &name) const;
 
@@ -0,0 +1,357 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Options.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+#define OPTIONS_LINE_LENGTH 80
+#define OPTIONS_MIN_DESCRIPTION_LENGTH 40
+#define OPTIONS_MIN_COLUMN_WIDTH 23
+
+// " 'prefixname'", or nothing when there is no name
+static string quoted(const char *prefix, const string &name) {
+    return name.empty() ? string() : string(" '") + prefix + name + "'";
+}
+
+// strictly an optionally signed decimal, without spaces
+static bool parseLong(const char *s, long *number) {
+    const char *digits = (*s == '+' || *s == '-') ? s + 1 : s;
+    if (*digits < '0' || *digits > '9')
+        return false;
+    char *end;
+    errno = 0;
+    *number = strtol(s, &end, 10);
+    return !*end && errno != ERANGE;
+}
+
+// trim spaces, tabs and line ends
+static string trim(const string &s) {
+    const size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == string::npos)
+        return string();
+    return s.substr(first, s.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+Options::Options(const char *cliCaption, const char *fileCaption, vector<Option> options)
+        : cliCaption(cliCaption), fileCaption(fileCaption), options(move(options)), values(this->options.size()) {
+    applyDefaults();
+}
+
+void Options::parse(const int &argc, const char *const *argv) {
+    vector<Token> tokens;
+    tokens.reserve((size_t) max(argc, 1));
+
+    int next = 1;
+    while (next < argc) {
+        const char *arg = argv[next];
+        const size_t length = strlen(arg);
+        if (length >= 3 && arg[0] == '-' && arg[1] == '-') {
+
+            // --name, --name=value or --name value
+            const char *equals = strchr(arg, '=');
+            const size_t nameLength = equals ? (size_t) (equals - arg - 2) : length - 2;
+            if (equals && !equals[1])
+                throw invalid_argument("the argument for option" + quoted("--", string(arg + 2, nameLength)) +
+                                       " should follow immediately after the equal sign");
+            next++;
+            if (!nameLength) {
+                tokens.push_back({-1, equals + 1, arg, false});
+                continue;
+            }
+            Token token{find(arg + 2, nameLength, true, arg), equals ? equals + 1 : nullptr, arg, false};
+            finish(token, argc, argv, &next);
+            tokens.push_back(token);
+
+        } else if (length >= 2 && arg[0] == '-' && arg[1] != '-') {
+
+            // -n, -nvalue or -n value, preceded by any number of flags
+            next++;
+            for (const char *c = arg + 1;; c++) {
+                const int option = findShort(*c);
+                if (option >= 0 && options[option].kind == flag && c[1]) {
+                    tokens.push_back({option, nullptr, arg, false});
+                    continue;
+                }
+                if (option < 0)
+                    throw invalid_argument("unrecognised option '" + string(arg) + "'");
+                Token token{option, c[1] ? c + 1 : nullptr, arg, false};
+                finish(token, argc, argv, &next);
+                tokens.push_back(token);
+                break;
+            }
+
+        } else if (!strcmp(arg, "--")) {
+
+            // everything else is an argument
+            for (next++; next < argc; next++)
+                tokens.push_back({-1, argv[next], argv[next], true});
+
+        } else {
+            tokens.push_back({-1, arg, arg, false});
+            next++;
+        }
+    }
+
+    // an option with an implicit value takes the argument that follows it
+    for (size_t i = 0; i + 1 < tokens.size(); i++) {
+        Token &token = tokens[i];
+        const Token &following = tokens[i + 1];
+        if (token.option >= 0 && options[token.option].implicitValue && !token.value && following.option < 0 &&
+            !following.terminated)
+            token.value = following.value;
+    }
+
+    for (const auto &token : tokens)
+        if (token.option >= 0)
+            store(token.option, token.value, "--");
+    for (auto &value : values)
+        value.final = value.given;
+    applyDefaults();
+}
+
+void Options::parse(istream &in) {
+    vector<pair<int, string>> entries;
+
+    string line;
+    string section;
+    while (getline(in, line)) {
+        const size_t comment = line.find('#');
+        if (comment != string::npos)
+            line.erase(comment);
+        line = trim(line);
+        if (line.empty())
+            continue;
+        if (line.front() == '[' && line.back() == ']') {
+            section = line.substr(1, line.size() - 2);
+            if (section.empty() || section.back() != '.')
+                section += '.';
+            continue;
+        }
+        const size_t equals = line.find('=');
+        if (equals == string::npos)
+            throw invalid_argument("the options configuration file contains an invalid line '" + line + "'");
+        const string name = section + trim(line.substr(0, equals));
+        int option = -1;
+        for (size_t i = 0; i < options.size() && option < 0; i++)
+            if (options[i].file && name == options[i].name)
+                option = (int) i;
+        if (option < 0)
+            throw invalid_argument("unrecognised option" + quoted("", name));
+        entries.emplace_back(option, trim(line.substr(equals + 1)));
+    }
+
+    for (const auto &entry : entries)
+        store(entry.first, entry.second.c_str(), "");
+    applyDefaults();
+}
+
+size_t Options::count(const char *name) const {
+    const Value &v = value(name);
+    return v.given || v.defaulted ? 1 : 0;
+}
+
+long Options::numberValue(const char *name) const {
+    return value(name).number;
+}
+
+const string &Options::textValue(const char *name) const {
+    static const string none;
+    const Value &v = value(name);
+    return v.texts.empty() ? none : v.texts.front();
+}
+
+const vector<string> &Options::textValues(const char *name) const {
+    return value(name).texts;
+}
+
+int Options::find(const char *name, const size_t &length, const bool &guess, const string &original) const {
+    vector<string> candidates;
+    int found = -1;
+    for (size_t i = 0; i < options.size(); i++) {
+        const char *optionName = options[i].name;
+        if (strlen(optionName) == length && !strncmp(optionName, name, length))
+            return (int) i;
+        if (guess && !strncmp(optionName, name, length)) {
+            candidates.emplace_back(optionName);
+            found = (int) i;
+        }
+    }
+    if (candidates.empty())
+        throw invalid_argument("unrecognised option" + quoted("", original));
+    if (candidates.size() > 1) {
+        sort(candidates.begin(), candidates.end());
+        string message = "option '" + original + "' is ambiguous and matches ";
+        for (size_t i = 0; i + 1 < candidates.size(); i++)
+            message += "'--" + candidates[i] + "', ";
+        throw invalid_argument(message + "and '--" + candidates.back() + "'");
+    }
+    return found;
+}
+
+int Options::findShort(const char &shortName) const {
+    for (size_t i = 0; i < options.size(); i++)
+        if (options[i].shortName && options[i].shortName == shortName)
+            return (int) i;
+    return -1;
+}
+
+void Options::finish(Token &token, const int &argc, const char *const *argv, int *next) const {
+    const Option &option = options[token.option];
+    if (option.kind == flag) {
+        if (token.value)
+            throw invalid_argument("option '--" + string(option.name) + "' does not take any arguments");
+        return;
+    }
+    if (token.value || option.implicitValue)
+        return;
+
+    // the following argument is taken unless it is another option's short name or is malformed
+    const char *following = *next < argc ? argv[*next] : nullptr;
+    if (following && following[0] == '-' && following[1] == '-' && following[2]) {
+        const char *equals = strchr(following, '=');
+        if (equals && !equals[1])
+            throw invalid_argument("the argument for option '--" + string(option.name) +
+                                   "' should follow immediately after the equal sign");
+    }
+    if (!following || (following[0] == '-' && following[1] && following[1] != '-' && !following[2] &&
+                       findShort(following[1]) >= 0))
+        throw invalid_argument("the required argument for option '--" + string(option.name) + "' is missing");
+    token.value = following;
+    (*next)++;
+}
+
+void Options::store(const int &option, const char *value, const char *prefix) {
+    const Option &o = options[option];
+    Value &v = values[option];
+    if (v.final)
+        return;
+    if (v.defaulted) {
+        v = Value();
+    }
+
+    if (o.kind == texts) {
+        v.texts.emplace_back(value);
+    } else if (o.kind != flag && !value) {
+        v.texts.assign(1, o.implicitValue);
+        parseLong(o.implicitValue, &v.number);
+    } else {
+        if (v.given)
+            throw invalid_argument("option '" + string(prefix) + o.name + "' cannot be specified more than once");
+        if (o.kind == number && !parseLong(value, &v.number))
+            throw invalid_argument(string("the argument") + (*value ? " ('" + string(value) + "')" : "") +
+                                   " for option '" + prefix + o.name + "' is invalid");
+        if (o.kind == text)
+            v.texts.assign(1, value);
+    }
+    v.given = true;
+}
+
+void Options::applyDefaults() {
+    for (size_t i = 0; i < options.size(); i++) {
+        Value &v = values[i];
+        if (v.given || !options[i].defaultValue)
+            continue;
+        v.defaulted = true;
+        v.texts.assign(1, options[i].defaultValue);
+        parseLong(options[i].defaultValue, &v.number);
+    }
+}
+
+const Options::Value &Options::value(const char *name) const {
+    for (size_t i = 0; i < options.size(); i++)
+        if (!strcmp(options[i].name, name))
+            return values[i];
+    throw invalid_argument(string("unknown option ") + name);
+}
+
+string Options::caption(const Option &option) const {
+    string caption = "  ";
+    if (option.shortName)
+        caption += string("-") + option.shortName + " [ --" + option.name + " ]";
+    else
+        caption += string("--") + option.name;
+    caption += ' ';
+    if (option.kind != flag) {
+        if (option.implicitValue)
+            caption += string("[=arg(=") + option.implicitValue + ")]";
+        else
+            caption += "arg";
+        if (option.defaultValue)
+            caption += string(" (=") + option.defaultValue + ")";
+    }
+    return caption;
+}
+
+ostream &operator<<(ostream &os, const Options &options) {
+
+    // descriptions are aligned in a column after the widest caption, within limits
+    // as boost::program_options nests the file section, its column is computed first and widens the whole by one
+    const size_t maxWidth = OPTIONS_LINE_LENGTH - OPTIONS_MIN_DESCRIPTION_LENGTH - 1;
+    size_t fileWidth = OPTIONS_MIN_COLUMN_WIDTH;
+    size_t width = OPTIONS_MIN_COLUMN_WIDTH;
+    for (const auto &option : options.options) {
+        width = max(width, options.caption(option).size());
+        if (option.file)
+            fileWidth = max(fileWidth, options.caption(option).size());
+    }
+    width = min(max(width, min(fileWidth, maxWidth) + 1), maxWidth) + 1;
+
+    // descriptions are wrapped at spaces, unless that would leave less than half a line
+    const size_t lineLength = OPTIONS_LINE_LENGTH - 1 - width;
+
+    for (const bool &file : {false, true}) {
+        if (file)
+            os << "\n";
+        os << (file ? options.fileCaption : options.cliCaption) << ":\n";
+        for (const auto &option : options.options) {
+            if (option.file != file)
+                continue;
+            const string caption = options.caption(option);
+            os << caption;
+            if (caption.size() >= width)
+                os << "\n" << string(width, ' ');
+            else
+                os << string(width - caption.size(), ' ');
+
+            const string description = option.description;
+            size_t begin = 0;
+            while (begin < description.size()) {
+                if (begin && description[begin] == ' ' && begin + 1 < description.size() &&
+                    description[begin + 1] != ' ')
+                    begin++;
+                size_t end = min(description.size(), begin + lineLength);
+                if (description[end - 1] != ' ' && end < description.size() && description[end] != ' ') {
+                    const size_t space = description.rfind(' ', end - 1);
+                    if (space != string::npos && space >= begin && space + 1 != begin &&
+                        end - (space + 1) < lineLength / 2)
+                        end = space + 1;
+                }
+                os << description.substr(begin, end - begin);
+                if (end != description.size())
+                    os << "\n" << string(width, ' ');
+                begin = end;
+            }
+            os << "\n";
+        }
+    }
+    return os;
+}
@@ -0,0 +1,141 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_OPTIONS_H
+#define XLAYOUTDISPLAY_OPTIONS_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// command line and options file parser, accepting the same syntax as boost::program_options' defaults and failing
+// with the same messages
+// long options may be abbreviated to any unique prefix; short flags may be grouped e.g. -qn
+// argv tokens are referenced rather than copied; only string values are copied, when stored
+// options given on the command line take precedence over those in files
+class Options {
+public:
+    enum Kind {
+        flag, number, text, texts
+    };
+
+    struct Option {
+        // long name, used in files
+        const char *name;
+
+        // zero when none
+        char shortName;
+
+        // texts may be repeated
+        Kind kind;
+
+        // also accepted in files
+        bool file;
+
+        const char *description;
+
+        // used when given without an argument; nullptr when an argument is required
+        const char *implicitValue;
+
+        // used when not given; nullptr when none
+        const char *defaultValue;
+    };
+
+    // help is shown in two sections: command line only options then those also accepted in files
+    Options(const char *cliCaption, const char *fileCaption, std::vector<Option> options);
+
+    // argv[0] is ignored, as are arguments that are not options
+    // throws invalid_argument:
+    //   unrecognised or ambiguous option
+    //   missing, unexpected or invalid argument
+    //   option given more than once
+    void parse(const int &argc, const char *const *argv);
+
+    // name=value lines, # comments and [section] name prefixes; ignores options already given on the command line
+    // throws invalid_argument:
+    //   unrecognised option
+    //   invalid line
+    //   invalid argument
+    //   option given more than once
+    void parse(std::istream &in);
+
+    // 1 when given or defaulted
+    size_t count(const char *name) const;
+
+    // zero when not given
+    long numberValue(const char *name) const;
+
+    // empty when not given
+    const std::string &textValue(const char *name) const;
+
+    // empty when not given
+    const std::vector<std::string> &textValues(const char *name) const;
+
+    friend std::ostream &operator<<(std::ostream &os, const Options &options);
+
+private:
+    struct Value {
+        bool given = false;
+        bool defaulted = false;
+
+        // given on the command line
+        bool final = false;
+
+        long number = 0;
+        std::vector<std::string> texts;
+    };
+
+    // a parsed option, or an argument when option is negative
+    struct Token {
+        int option;
+
+        // nullptr when none
+        const char *value;
+
+        // as given, for messages
+        const char *original;
+
+        // follows --
+        bool terminated;
+    };
+
+    // option with name, or name abbreviated when guess
+    // throws invalid_argument:
+    //   unrecognised or ambiguous option
+    int find(const char *name, const size_t &length, const bool &guess, const std::string &original) const;
+
+    // option with shortName, negative when none
+    int findShort(const char &shortName) const;
+
+    // take the required argument for token from argv[*next], advancing next
+    void finish(Token &token, const int &argc, const char *const *argv, int *next) const;
+
+    // prefix is -- for the command line
+    void store(const int &option, const char *value, const char *prefix);
+
+    void applyDefaults();
+
+    const Value &value(const char *name) const;
+
+    std::string caption(const Option &option) const;
+
+    const char *cliCaption;
+    const char *fileCaption;
+    const std::vector<Option> options;
+    std::vector<Value> values;
+};
+
+#endif //XLAYOUTDISPLAY_OPTIONS_H
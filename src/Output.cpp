@@ -23,17 +23,17 @@ using namespace std;
 
 Output::Output(const string &name,
              const State &state,
-             const list<shared_ptr<const Mode>> &modes,
+             const ModeTable &modes,
              const shared_ptr<const Mode> &currentMode,
              const shared_ptr<const Mode> &preferredMode,
              const shared_ptr<const Pos> &currentPos,
-             const shared_ptr<const Edid> &edid) :
+             const Lazy<const Edid> &edid) :
         name(name),
         state(state),
         modes(modes),
         currentMode(currentMode),
         preferredMode(preferredMode),
-        optimalMode(calculateOptimalMode(modes, preferredMode)),
+        optimalMode(calculateOptimalMode(this->modes, preferredMode)),
         currentPos(currentPos),
         edid(edid) {
     switch (state) {
@@ -56,3 +56,26 @@ Output::Output(const string &name,
     }
 }
 
+void Output::resetDesired() {
+    desiredActive = false;
+    desiredMode.reset();
+    desiredPos.reset();
+    desiredCrtc = 0;
+    desiredScaleFrom = {0, 0};
+}
+
+const pair<unsigned int, unsigned int> Output::currentArea() const {
+    if (currentScaleFrom.first && currentScaleFrom.second)
+        return currentScaleFrom;
+    if (currentMode)
+        return make_pair(currentMode->width, currentMode->height);
+    return {0, 0};
+}
+
+const pair<unsigned int, unsigned int> Output::desiredArea() const {
+    if (desiredScaleFrom.first && desiredScaleFrom.second)
+        return desiredScaleFrom;
+    if (desiredMode)
+        return make_pair(desiredMode->width, desiredMode->height);
+    return {0, 0};
+}
@@ -17,12 +17,16 @@
 #define XLAYOUTDISPLAY_DISPL_H
 
 #include "Mode.h"
+#include "ModeTable.h"
 #include "Pos.h"
 #include "Edid.h"
+#include "Lazy.h"
 #include "Monitors.h"
 
 #include <memory>
 #include <list>
+#include <utility>
+#include <vector>
 
 // a single Xrandr output
 class Output {
@@ -31,6 +35,11 @@ public:
         active, connected, disconnected
     };
 
+    // what must be done to take an output from its current to its desired state
+    enum Change {
+        unchanged, reposition, modeset, disable
+    };
+
     // throws invalid_argument:
     //   active must have: currentMode, currentPos, modes
     //   connected must have: modes
@@ -39,24 +48,47 @@ public:
     // optimalMode will be set to highest refresh preferredMode, then highest mode, then empty
     Output(const std::string &name,
            const State &state,
-           const std::list<std::shared_ptr<const Mode>> &modes,
+           const ModeTable &modes,
            const std::shared_ptr<const Mode> &currentMode,
            const std::shared_ptr<const Mode> &preferredMode,
            const std::shared_ptr<const Pos> &currentPos,
-           const std::shared_ptr<const Edid> &edid);
+           const Lazy<const Edid> &edid);
+
+    // forget desired state so that the output may be laid out again
+    void resetDesired();
+
+    // width and height of the screen covered by currentMode, or the area it is scaled from; zero when inactive
+    const std::pair<unsigned int, unsigned int> currentArea() const;
+
+    // width and height of the screen covered by desiredMode, or the area it is scaled from; zero when none
+    const std::pair<unsigned int, unsigned int> desiredArea() const;
 
     const std::string name;
     const State state;
-    const std::list<std::shared_ptr<const Mode>> modes;
+    const ModeTable modes;
     const std::shared_ptr<const Mode> currentMode;
     const std::shared_ptr<const Mode> preferredMode;
     const std::shared_ptr<const Mode> optimalMode;
     const std::shared_ptr<const Pos> currentPos;
-    const std::shared_ptr<const Edid> edid;
+    // may be loaded on first use
+    const Lazy<const Edid> edid;
+
+    // RandR identifiers, set during discovery; crtc is that currently in use, crtcs are those that may be used and
+    // clones are the outputs that may share a CRTC with this one
+    RROutput rrOutput = 0;
+    RRCrtc crtc = 0;
+    std::vector<RRCrtc> crtcs;
+    std::vector<RROutput> clones;
+    bool currentPrimary = false;
+    // screen area that currentMode is scaled from, zero when unscaled
+    std::pair<unsigned int, unsigned int> currentScaleFrom;
 
     bool desiredActive = false;
     std::shared_ptr<const Mode> desiredMode;
     std::shared_ptr<const Pos> desiredPos;
+    RRCrtc desiredCrtc = 0;
+    // screen area that desiredMode will be scaled from, zero when unscaled
+    std::pair<unsigned int, unsigned int> desiredScaleFrom;
 };
 
 
@@ -0,0 +1,75 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "OutputOrder.h"
+
+#include <fnmatch.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+OutputOrder::OutputOrder(const vector<string> &order) : nEntries(order.size()), entries(order) {
+    for (size_t i = 0; i < order.size(); i++) {
+        const string &entry = order[i];
+
+        if (strncasecmp(entry.c_str(), OUTPUT_ORDER_EDID_PREFIX, strlen(OUTPUT_ORDER_EDID_PREFIX)) == 0) {
+            const char *hex = entry.c_str() + strlen(OUTPUT_ORDER_EDID_PREFIX);
+            char *end = nullptr;
+            errno = 0;
+            const unsigned long long fingerprint = strtoull(hex, &end, 16);
+            if (!isxdigit((unsigned char) *hex) || *end || errno || end - hex > 16)
+                throw invalid_argument("invalid order '" + entry + "', expected " OUTPUT_ORDER_EDID_PREFIX
+                                       " followed by 1 to 16 hex digits");
+            fingerprints.emplace(fingerprint, i);
+        } else if (entry.find_first_of("*?[") != string::npos) {
+            globs.emplace_back(i, entry);
+        } else {
+            names.emplace(nameHash(entry), i);
+        }
+    }
+}
+
+size_t OutputOrder::rank(const Output &output) const {
+    size_t rank = nEntries;
+
+    // entries of the same name are in order, so the first that is truly equal is the earliest
+    const auto candidates = names.equal_range(nameHash(output.name));
+    for (auto name = candidates.first; name != candidates.second; name++)
+        if (name->second < rank && strcasecmp(entries[name->second].c_str(), output.name.c_str()) == 0)
+            rank = name->second;
+
+    if (!fingerprints.empty() && output.edid) {
+        const auto fingerprint = fingerprints.find(output.edid->fingerprint());
+        if (fingerprint != fingerprints.end() && fingerprint->second < rank)
+            rank = fingerprint->second;
+    }
+
+    // only an earlier pattern can improve on that
+    for (const auto &glob : globs) {
+        if (glob.first >= rank)
+            break;
+        if (fnmatch(glob.second.c_str(), output.name.c_str(), FNM_CASEFOLD) == 0) {
+            rank = glob.first;
+            break;
+        }
+    }
+
+    return rank;
+}
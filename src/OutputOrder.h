@@ -0,0 +1,77 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_OUTPUTORDER_H
+#define XLAYOUTDISPLAY_OUTPUTORDER_H
+
+#include "Output.h"
+#include "util.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define OUTPUT_ORDER_EDID_PREFIX "edid:"
+
+// --order entries compiled once, so that an output is ranked by a lookup rather than a comparison with each entry
+// an entry is one of:
+//   edid:<hex fingerprint>, as shown by --info
+//   a glob pattern containing any of *?[ e.g. DP-*, case insensitive
+//   an exact output name, case insensitive
+class OutputOrder {
+public:
+    // FNV-1a of name, ASCII case folded
+    static uint64_t nameHash(const std::string &name) {
+        uint64_t hash = FNV1A_OFFSET_BASIS;
+        for (const char &c : name) {
+            hash ^= (uint64_t) (c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            hash *= FNV1A_PRIME;
+        }
+        return hash;
+    }
+
+    // throws invalid_argument:
+    //   edid: entry that is not 1 to 16 hex digits
+    OutputOrder(const std::vector<std::string> &order);
+
+    // index of the first entry matching output, size() when none match
+    size_t rank(const Output &output) const;
+
+    // number of entries
+    size_t size() const { return nEntries; }
+
+    bool empty() const { return nEntries == 0; }
+
+    // true when ranking reads EDID
+    bool matchesEdid() const { return !fingerprints.empty(); }
+
+private:
+    size_t nEntries;
+
+    // case folded hash of each name to its entries
+    std::unordered_multimap<uint64_t, size_t> names;
+
+    std::vector<std::string> entries;
+
+    // fingerprint to the first entry for it
+    std::unordered_map<uint64_t, size_t> fingerprints;
+
+    // entry index and pattern, in entry order
+    std::vector<std::pair<size_t, std::string>> globs;
+};
+
+#endif //XLAYOUTDISPLAY_OUTPUTORDER_H
@@ -0,0 +1,323 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "ProfileCache.h"
+#include "Arena.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+#define PROFILE_CACHE_MAGIC 0x504c4458 // "XDLP"
+#define PROFILE_CACHE_VERSION 2
+#define PROFILE_CACHE_NAME_LENGTH 32
+
+// file layout: Header, then for each profile a ProfileRecord followed by its OutputRecords
+// all fields are host endian; the cache is not meant to be shared between machines
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nprofile;
+    uint32_t reserved;
+};
+
+struct ProfileRecord {
+    uint64_t profile;
+    uint64_t settings;
+    int64_t dpi;
+    uint32_t noutput;
+    uint32_t reserved;
+};
+
+struct OutputRecord {
+    char name[PROFILE_CACHE_NAME_LENGTH];
+    uint64_t rrMode;
+    uint32_t width;
+    uint32_t height;
+    uint32_t refresh;
+    int32_t x;
+    int32_t y;
+    uint32_t scaleFromWidth;
+    uint32_t scaleFromHeight;
+    uint8_t active;
+    uint8_t primary;
+    uint8_t reserved[2];
+};
+
+// read only mapping of the cache, with profiles empty when the file is missing or invalid
+class MappedProfiles {
+public:
+    explicit MappedProfiles(const string &path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(Header)) {
+            size = (size_t) st.st_size;
+            void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+                data = static_cast<const char *>(mapped);
+        }
+        close(fd);
+        if (data)
+            index();
+    }
+
+    MappedProfiles(const MappedProfiles &) = delete;
+
+    MappedProfiles &operator=(const MappedProfiles &) = delete;
+
+    ~MappedProfiles() {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+    }
+
+    // pointers into the mapping, valid for the lifetime of this
+    vector<pair<const ProfileRecord *, const OutputRecord *>> profiles;
+
+private:
+    // validate everything up front, discarding all when anything is out of place
+    void index() {
+        const auto *header = reinterpret_cast<const Header *>(data);
+        if (header->magic != PROFILE_CACHE_MAGIC || header->version != PROFILE_CACHE_VERSION)
+            return;
+        size_t offset = sizeof(Header);
+        for (uint32_t i = 0; i < header->nprofile; i++) {
+            if (offset + sizeof(ProfileRecord) > size) {
+                profiles.clear();
+                return;
+            }
+            const auto *profile = reinterpret_cast<const ProfileRecord *>(data + offset);
+            offset += sizeof(ProfileRecord);
+            if (profile->noutput > (size - offset) / sizeof(OutputRecord)) {
+                profiles.clear();
+                return;
+            }
+            profiles.emplace_back(profile, reinterpret_cast<const OutputRecord *>(data + offset));
+            offset += profile->noutput * sizeof(OutputRecord);
+        }
+    }
+
+    const char *data = nullptr;
+    size_t size = 0;
+};
+
+// create each missing directory leading to path
+static void makeParents(const string &path) {
+    for (size_t slash = path.find('/', 1); slash != string::npos; slash = path.find('/', slash + 1)) {
+        const string dir = path.substr(0, slash);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            throw system_error(errno, generic_category(), "unable to create " + dir);
+    }
+}
+
+// the mode of output with rrMode, otherwise one of the same resolution and refresh
+static const shared_ptr<const Mode> findMode(const shared_ptr<Output> &output, const OutputRecord &record) {
+    for (const auto &mode : output->modes)
+        if (mode->rrMode == record.rrMode &&
+            mode->width == record.width && mode->height == record.height && mode->refresh == record.refresh)
+            return mode;
+    for (const auto &mode : output->modes)
+        if (mode->width == record.width && mode->height == record.height && mode->refresh == record.refresh)
+            return mode;
+    return shared_ptr<const Mode>();
+}
+
+const string ProfileCache::defaultPath() {
+    const char *xdgCacheHome = getenv("XDG_CACHE_HOME");
+    if (xdgCacheHome && *xdgCacheHome == '/')
+        return string(xdgCacheHome) + "/" + PROFILE_CACHE_RELATIVE_PATH;
+    return resolveTildePath(".cache/" PROFILE_CACHE_RELATIVE_PATH);
+}
+
+uint64_t ProfileCache::profileKey(const list<shared_ptr<Output>> &outputs) {
+
+    // hash each connected output, then combine them in sorted order
+    vector<uint64_t> hashes;
+    for (const auto &output : outputs) {
+        if (output->state == Output::disconnected)
+            continue;
+        uint64_t hash = fnv1a(output->name.data(), output->name.size());
+        if (output->edid) {
+            const uint64_t fingerprint = output->edid->fingerprint();
+            hash = fnv1a(&fingerprint, sizeof(fingerprint), hash);
+        }
+        hashes.push_back(hash);
+    }
+    sort(hashes.begin(), hashes.end());
+    return fnv1a(hashes.data(), hashes.size() * sizeof(uint64_t));
+}
+
+uint64_t ProfileCache::settingsKey(const Settings &settings, const bool &laptopLidClosed) {
+    stringstream ss;
+    ss << "dpi=" << settings.dpi << "\nrate=" << settings.rate << "\nmirror=" << settings.mirror
+       << "\nscaledMirror=" << settings.scaledMirror << "\norder=";
+    for (const auto &name : settings.order)
+        ss << name << ",";
+    ss << "\nprimary=" << settings.primary << "\nlid=" << laptopLidClosed << "\n";
+    const string serialised = ss.str();
+    return fnv1a(serialised.data(), serialised.size());
+}
+
+bool ProfileCache::load(const uint64_t &profile, const uint64_t &settings, const list<shared_ptr<Output>> &outputs,
+                        shared_ptr<Output> *primary, long *dpi) const {
+    const MappedProfiles mapped(path);
+    for (const auto &entry : mapped.profiles) {
+        if (entry.first->profile != profile)
+            continue;
+        if (entry.first->settings != settings)
+            return false;
+
+        // resolve everything before touching outputs
+        vector<tuple<shared_ptr<Output>, shared_ptr<const Mode>, shared_ptr<const Pos>,
+                pair<unsigned int, unsigned int>>> plan;
+        plan.reserve(entry.first->noutput);
+        shared_ptr<Output> cachedPrimary;
+        Arena<Pos> positions(entry.first->noutput);
+        for (uint32_t i = 0; i < entry.first->noutput; i++) {
+            const OutputRecord &record = entry.second[i];
+            const string name(record.name, strnlen(record.name, PROFILE_CACHE_NAME_LENGTH));
+            const auto output = find_if(outputs.begin(), outputs.end(),
+                                        [&name](const shared_ptr<Output> &o) { return o->name == name; });
+            if (output == outputs.end())
+                return false;
+            if (!record.active)
+                continue;
+            const shared_ptr<const Mode> mode = findMode(*output, record);
+            if (!mode)
+                return false;
+            plan.emplace_back(*output, mode, positions.make(record.x, record.y),
+                              make_pair(record.scaleFromWidth, record.scaleFromHeight));
+            if (record.primary)
+                cachedPrimary = *output;
+        }
+
+        for (const auto &output : outputs)
+            output->desiredActive = false;
+        for (const auto &step : plan) {
+            get<0>(step)->desiredActive = true;
+            get<0>(step)->desiredMode = get<1>(step);
+            get<0>(step)->desiredPos = get<2>(step);
+            get<0>(step)->desiredScaleFrom = get<3>(step);
+        }
+        *primary = cachedPrimary;
+        *dpi = (long) entry.first->dpi;
+        return true;
+    }
+    return false;
+}
+
+void ProfileCache::store(const uint64_t &profile, const uint64_t &settings, const list<shared_ptr<Output>> &outputs,
+                         const shared_ptr<Output> &primary, const long &dpi) const {
+
+    // the new layout
+    ProfileRecord profileRecord{profile, settings, dpi, 0, 0};
+    vector<OutputRecord> outputRecords;
+    for (const auto &output : outputs) {
+        if (output->state == Output::disconnected)
+            continue;
+        if (output->name.size() > PROFILE_CACHE_NAME_LENGTH)
+            throw invalid_argument("output name '" + output->name + "' is too long to cache");
+        OutputRecord record{};
+        memcpy(record.name, output->name.data(), output->name.size());
+        if (output->desiredActive && output->desiredMode && output->desiredPos) {
+            record.active = 1;
+            record.primary = output == primary;
+            record.rrMode = output->desiredMode->rrMode;
+            record.width = output->desiredMode->width;
+            record.height = output->desiredMode->height;
+            record.refresh = output->desiredMode->refresh;
+            record.x = output->desiredPos->x;
+            record.y = output->desiredPos->y;
+            record.scaleFromWidth = output->desiredScaleFrom.first;
+            record.scaleFromHeight = output->desiredScaleFrom.second;
+        }
+        outputRecords.push_back(record);
+    }
+    profileRecord.noutput = (uint32_t) outputRecords.size();
+
+    // existing layouts, oldest first, less any for this profile and those that no longer fit
+    // the cache is read then replaced by one thread at a time, so that a fleet's layouts are all kept
+    static mutex storing;
+    const lock_guard<mutex> lock(storing);
+    string contents;
+    Header header{PROFILE_CACHE_MAGIC, PROFILE_CACHE_VERSION, 0, 0};
+    {
+        const MappedProfiles mapped(path);
+        size_t keep = 0;
+        for (const auto &entry : mapped.profiles)
+            if (entry.first->profile != profile)
+                keep++;
+        size_t skip = keep >= PROFILE_CACHE_MAX_PROFILES ? keep - PROFILE_CACHE_MAX_PROFILES + 1 : 0;
+        for (const auto &entry : mapped.profiles) {
+            if (entry.first->profile == profile)
+                continue;
+            if (skip) {
+                skip--;
+                continue;
+            }
+            contents.append(reinterpret_cast<const char *>(entry.first), sizeof(ProfileRecord));
+            contents.append(reinterpret_cast<const char *>(entry.second), entry.first->noutput * sizeof(OutputRecord));
+            header.nprofile++;
+        }
+    }
+    contents.append(reinterpret_cast<const char *>(&profileRecord), sizeof(ProfileRecord));
+    contents.append(reinterpret_cast<const char *>(outputRecords.data()), outputRecords.size() * sizeof(OutputRecord));
+    header.nprofile++;
+    contents.insert(0, reinterpret_cast<const char *>(&header), sizeof(Header));
+
+    // replace atomically, so that readers never see a partial cache
+    // the file is uniquely named alongside the cache, so that other processes storing at once cannot write into it
+    makeParents(path);
+    vector<char> tmpPath(path.begin(), path.end());
+    const string suffix = ".XXXXXX";
+    tmpPath.insert(tmpPath.end(), suffix.begin(), suffix.end());
+    tmpPath.push_back('\0');
+    const int fd = mkstemp(tmpPath.data());
+    if (fd < 0)
+        throw system_error(errno, generic_category(), "unable to write " + string(tmpPath.data()));
+    FILE *file = fdopen(fd, "wb");
+    if (!file) {
+        const int error = errno;
+        close(fd);
+        unlink(tmpPath.data());
+        throw system_error(error, generic_category(), "unable to write " + string(tmpPath.data()));
+    }
+    const bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    if (fclose(file) != 0 || !written) {
+        unlink(tmpPath.data());
+        throw runtime_error("unable to write " + string(tmpPath.data()));
+    }
+    if (rename(tmpPath.data(), path.c_str()) != 0) {
+        const int error = errno;
+        unlink(tmpPath.data());
+        throw system_error(error, generic_category(), "unable to replace " + path);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_PROFILECACHE_H
+#define XLAYOUTDISPLAY_PROFILECACHE_H
+
+#include "Output.h"
+#include "Settings.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#define PROFILE_CACHE_RELATIVE_PATH "xlayoutdisplay/profiles"
+#define PROFILE_CACHE_MAX_PROFILES 32
+
+// layouts previously calculated for a combination of monitors and settings, persisted in a compact binary file that
+// is memory mapped when read
+class ProfileCache {
+public:
+    explicit ProfileCache(const std::string &path) : path(path) {}
+
+    // $XDG_CACHE_HOME/PROFILE_CACHE_RELATIVE_PATH, falling back to ~/.cache/PROFILE_CACHE_RELATIVE_PATH
+    static const std::string defaultPath();
+
+    // identifies the connected monitors by output name and EDID fingerprint, regardless of order
+    // loads the Edid of connected outputs
+    static uint64_t profileKey(const std::list<std::shared_ptr<Output>> &outputs);
+
+    // identifies everything else that influences a layout
+    static uint64_t settingsKey(const Settings &settings, const bool &laptopLidClosed);
+
+    // set desired state of outputs, primary and dpi from the layout cached for profile
+    // modes are matched by RRMode, then by resolution and refresh
+    // returns false, leaving outputs untouched, when there is no such layout, it was cached with different settings, or
+    // it no longer fits the outputs
+    bool load(const uint64_t &profile, const uint64_t &settings, const std::list<std::shared_ptr<Output>> &outputs,
+              std::shared_ptr<Output> *primary, long *dpi) const;
+
+    // remember the desired state of outputs, primary and dpi for profile, replacing any existing layout
+    // the oldest layout is dropped when there are more than PROFILE_CACHE_MAX_PROFILES
+    // throws invalid_argument:
+    //   output name too long
+    // throws runtime_error:
+    //   unable to write the cache
+    void store(const uint64_t &profile, const uint64_t &settings, const std::list<std::shared_ptr<Output>> &outputs,
+               const std::shared_ptr<Output> &primary, const long &dpi) const;
+
+    const std::string path;
+};
+
+#endif //XLAYOUTDISPLAY_PROFILECACHE_H
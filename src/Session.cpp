@@ -0,0 +1,48 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Session.h"
+
+#include <X11/Xlib-xcb.h>
+
+#include <string>
+#include <system_error>
+
+using namespace std;
+
+// Xlib exits the process by default
+static void ignoreIOError(Display *, void *) {
+}
+
+Session::Session(const char *displayName) :
+        dpy(openDisplay(displayName)),
+        root(RootWindow(dpy, DefaultScreen(dpy))),
+        conn(XGetXCBConnection(dpy)),
+        traffic(conn),
+        atoms(conn, traffic) {
+}
+
+Session::~Session() {
+    atoms.discard();
+    XCloseDisplay(dpy);
+}
+
+Display *Session::openDisplay(const char *displayName) {
+    Display *dpy = XOpenDisplay(displayName);
+    if (!dpy)
+        throw domain_error(string("unable to open display '") + XDisplayName(displayName) + "'");
+    XSetIOErrorExitHandler(dpy, ignoreIOError, nullptr);
+    return dpy;
+}
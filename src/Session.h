@@ -0,0 +1,58 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_SESSION_H
+#define XLAYOUTDISPLAY_SESSION_H
+
+#include "Atoms.h"
+#include "XTraffic.h"
+
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+
+// a single connection to an X display, shared by all stages that talk to X via std::shared_ptr
+// the display is closed when the last reference is released
+// losing the connection does not exit the process: Xlib calls then do nothing and xcb replies are null, so the loss is
+// reported as an error by whichever stage next waits for a reply, failing only the work using this display
+class Session {
+public:
+    // open displayName, the default display when nullptr
+    // throws domain_error:
+    //   unable to open display
+    explicit Session(const char *displayName = nullptr);
+
+    Session(const Session &) = delete;
+
+    Session &operator=(const Session &) = delete;
+
+    virtual ~Session();
+
+    Display *const dpy;
+    const Window root;
+
+    // the Xlib connection, for xcb requests
+    xcb_connection_t *const conn;
+
+    // requests and round trips made by those who use conn, which must record them
+    XTraffic traffic;
+
+    // atoms for this connection
+    Atoms atoms;
+
+private:
+    static Display *openDisplay(const char *displayName);
+};
+
+#endif //XLAYOUTDISPLAY_SESSION_H
@@ -0,0 +1,68 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Settings.h"
+#include "fleet.h"
+
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+
+Options settingsOptions() {
+    return Options("CLI", "CLI, /etc/xlayoutdisplay and ~/.xlayoutdisplay", {
+
+            // command line options
+            {"daemon", 0, Options::flag, false, "stay resident and lay out again whenever outputs change", nullptr,
+             nullptr},
+            {"display", 0, Options::texts, false, "X display to lay out instead of $DISPLAY, repeat with --fleet",
+             nullptr, nullptr},
+            {"fleet", 0, Options::flag, false,
+             "lay out each --display, or all local displays when none, in parallel", nullptr, nullptr},
+            {"help", 'h', Options::flag, false, "print this help text and exit", nullptr, nullptr},
+            {"info", 'i', Options::flag, false, "print information about current outputs and exit", nullptr, nullptr},
+            {"jobs", 0, Options::number, false,
+             "fleet: displays laid out at once, default " TO_STRING(FLEET_DEFAULT_JOBS), nullptr, nullptr},
+            {"noop", 'n', Options::flag, false, "perform a trial run and exit", nullptr, nullptr},
+            {"nocache", 0, Options::flag, false, "neither use nor update the cache of previous layouts", nullptr,
+             nullptr},
+            {"probe", 0, Options::flag, false,
+             "poll the hardware for output changes instead of using the X server's current state", nullptr, nullptr},
+            {"record", 0, Options::text, false, "record outputs, EDID and laptop lid to a snapshot file and exit",
+             nullptr, nullptr},
+            {"snapshot", 0, Options::text, false,
+             "lay out a recorded snapshot file instead of the X server, implies --nocache", nullptr, nullptr},
+            {"timings", 0, Options::text, false, "print the time taken by each phase, --timings=json for JSON", "text",
+             nullptr},
+            {"version", 'v', Options::flag, false, "print version string", nullptr, nullptr},
+
+            // command line and file options
+            {"dpi", 'd', Options::number, true, "DPI override", nullptr, nullptr},
+            {"rate", 'r', Options::number, true, "Refresh rate override", nullptr, nullptr},
+            {"mirror", 'm', Options::flag, true, "mirror outputs using the lowest common resolution", nullptr, nullptr},
+            {"scaled-mirror", 0, Options::text, true,
+             "mirror outputs at their own optimal resolutions, scaled from the primary's or, "
+             "--scaled-mirror=largest, the largest; overrides --mirror", "primary", nullptr},
+            {"order", 'o', Options::texts, true,
+             "order of outputs by name, glob e.g. DP-* or edid:FINGERPRINT from --info, repeat as needed", nullptr,
+             nullptr},
+            {"primary", 'p', Options::text, true, "primary output", nullptr, nullptr},
+            {"quiet", 'q', Options::flag, true, "suppress feedback", nullptr, nullptr},
+            {"settle", 0, Options::number, true, "daemon: milliseconds without RandR events before laying out",
+             nullptr, "250"},
+            {"xrandr", 0, Options::flag, true, "apply using the xrandr command rather than RandR directly", nullptr,
+             nullptr},
+            {"xrdb", 0, Options::flag, true, "set Xft.dpi using the xrdb command rather than directly", nullptr,
+             nullptr},
+    });
+}
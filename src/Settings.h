@@ -16,32 +16,69 @@
 #ifndef XLAYOUTDISPLAY_SETTINGS_H
 #define XLAYOUTDISPLAY_SETTINGS_H
 
+#include "Options.h"
+#include "OutputOrder.h"
+
 #include <list>
 #include <string>
 #include <vector>
-#include <boost/program_options/variables_map.hpp>
+
+// options understood by Settings: those for the command line, /etc/xlayoutdisplay and ~/.xlayoutdisplay
+Options settingsOptions();
 
 // user provided settings for this utility
 class Settings {
 public:
-    Settings(const boost::program_options::variables_map &vm)
-            : dpi(vm.count("dpi") ? vm["dpi"].as<const long>() : 0),
-              rate(vm.count("rate") ? vm["rate"].as<const long>() : 0),
-              info(vm.count("info")),
-              noop(vm.count("noop")),
-              mirror(vm.count("mirror")),
-              order(vm.count("order") ? vm["order"].as<std::vector<std::string>>() : std::vector<std::string>()),
-              primary(vm.count("primary") ? vm["primary"].as<std::string>() : std::string()),
-              quiet(vm.count("quiet")) {}
+    // throws invalid_argument:
+    //   invalid order entry
+    Settings(const Options &options)
+            : dpi(options.numberValue("dpi")),
+              rate(options.numberValue("rate")),
+              info(options.count("info")),
+              daemon(options.count("daemon")),
+              displays(options.textValues("display")),
+              fleet(options.count("fleet")),
+              jobs(options.numberValue("jobs")),
+              settle(options.numberValue("settle")),
+              noop(options.count("noop")),
+              nocache(options.count("nocache") || !options.textValue("snapshot").empty()),
+              probe(options.count("probe")),
+              mirror(options.count("mirror")),
+              order(options.textValues("order")),
+              outputOrder(order),
+              primary(options.textValue("primary")),
+              quiet(options.count("quiet")),
+              scaledMirror(options.textValue("scaled-mirror")),
+              record(options.textValue("record")),
+              snapshot(options.textValue("snapshot")),
+              timings(options.textValue("timings")),
+              xrandr(options.count("xrandr")),
+              xrdb(options.count("xrdb")) {}
 
     const long dpi;
     const long rate;
     const bool info;
+    const bool daemon;
+    const std::vector<std::string> displays;
+    const bool fleet;
+    const long jobs;
+    const long settle;
     const bool noop;
+    // also set by snapshot, whose outputs are not those of this machine
+    const bool nocache;
+    const bool probe;
     const bool mirror;
     const std::vector<std::string> order;
+    // order, compiled
+    const OutputOrder outputOrder;
     const std::string primary;
     const bool quiet;
+    const std::string scaledMirror;
+    const std::string record;
+    const std::string snapshot;
+    const std::string timings;
+    const bool xrandr;
+    const bool xrdb;
 };
 
 #endif //XLAYOUTDISPLAY_SETTINGS_H
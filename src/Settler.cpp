@@ -0,0 +1,55 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Settler.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+Settler::Settler(const chrono::milliseconds &settle) : settle(settle) {
+    if (settle.count() < 0)
+        throw invalid_argument("Settler received negative settle " + to_string(settle.count()) + "ms");
+}
+
+void Settler::event(const chrono::steady_clock::time_point &now) {
+    last = now;
+    events++;
+}
+
+bool Settler::event(const chrono::steady_clock::time_point &now, const unsigned long &serial) {
+    if (serial >= ownFirst && serial < ownLast)
+        return false;
+    event(now);
+    return true;
+}
+
+void Settler::own(const unsigned long &first, const unsigned long &last) {
+    ownFirst = first;
+    ownLast = last;
+}
+
+int Settler::timeout(const chrono::steady_clock::time_point &now) const {
+    if (!events)
+        return -1;
+
+    const chrono::steady_clock::time_point due = last + settle;
+    if (now >= due)
+        return 0;
+
+    // round up, so that the action is not attempted early
+    return (int) chrono::duration_cast<chrono::milliseconds>(due - now + chrono::milliseconds(1) -
+                                                            chrono::nanoseconds(1)).count();
+}
@@ -0,0 +1,55 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_SETTLER_H
+#define XLAYOUTDISPLAY_SETTLER_H
+
+#include <chrono>
+
+// collapses a burst of events into a single action, which is due once no event has arrived for the settle period
+class Settler {
+public:
+    // throws invalid_argument:
+    //   negative settle
+    explicit Settler(const std::chrono::milliseconds &settle);
+
+    // an event arrived at now
+    void event(const std::chrono::steady_clock::time_point &now);
+
+    // an event caused by the request numbered serial arrived at now
+    // returns false when ignored, having been caused by our own action
+    bool event(const std::chrono::steady_clock::time_point &now, const unsigned long &serial);
+
+    // our action made the requests numbered [first, last), whose events are ignored until the next action
+    void own(const unsigned long &first, const unsigned long &last);
+
+    // milliseconds until the action is due, zero when due, -1 when no events are pending; suitable for poll(2)
+    int timeout(const std::chrono::steady_clock::time_point &now) const;
+
+    // the pending events have been acted upon
+    void settled() { events = 0; }
+
+    // number of events since last settled
+    unsigned long pending() const { return events; }
+
+private:
+    const std::chrono::milliseconds settle;
+    std::chrono::steady_clock::time_point last;
+    unsigned long events = 0;
+    unsigned long ownFirst = 0;
+    unsigned long ownLast = 0;
+};
+
+#endif //XLAYOUTDISPLAY_SETTLER_H
@@ -0,0 +1,508 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "SnapshotBackend.h"
+
+#include "calculations.h"
+#include "ModeIndex.h"
+#include "Monitors.h"
+#include "xcbrandrutil.h"
+#include "xrandrrutil.h"
+#include "xrdbutil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <system_error>
+
+using namespace std;
+
+// a count followed by that many values
+template<typename T>
+static void readList(istream &in, vector<T> *values) {
+    size_t n = 0;
+    in >> n;
+    T value;
+    for (size_t i = 0; i < n && in >> value; i++)
+        values->push_back(value);
+}
+
+template<typename T>
+static void writeList(ostream &out, const vector<T> &values) {
+    out << ' ' << values.size();
+    for (const auto &value : values)
+        out << ' ' << value;
+}
+
+static void readHex(istream &in, vector<unsigned char> *bytes) {
+    string hex;
+    in >> hex;
+    if (hex.size() % 2) {
+        in.setstate(ios::failbit);
+        return;
+    }
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        const string digits = hex.substr(i, 2);
+        if (digits.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+            in.setstate(ios::failbit);
+            return;
+        }
+        bytes->push_back((unsigned char) stoul(digits, nullptr, 16));
+    }
+}
+
+SnapshotBackend::SnapshotBackend(istream &snapshot) {
+    string line;
+    unsigned int number = 0;
+    while (getline(snapshot, line)) {
+        number++;
+        istringstream in(line);
+        string type;
+        if (!(in >> type) || type[0] == '#')
+            continue;
+
+        if (type == "lid") {
+            string state;
+            in >> state;
+            if (state != "open" && state != "closed")
+                in.setstate(ios::failbit);
+            lidClosed = state == "closed";
+        } else if (type == "screen") {
+            in >> width >> height >> minWidth >> minHeight >> maxWidth >> maxHeight;
+            if (!in.eof() && !(in >> ws).eof())
+                in >> mmWidth >> mmHeight;
+        } else if (type == "primary") {
+            in >> primary;
+        } else if (type == "mode") {
+            XRRModeInfo modeInfo{};
+            in >> modeInfo.id >> modeInfo.width >> modeInfo.height >> modeInfo.dotClock
+               >> modeInfo.hSyncStart >> modeInfo.hSyncEnd >> modeInfo.hTotal >> modeInfo.hSkew
+               >> modeInfo.vSyncStart >> modeInfo.vSyncEnd >> modeInfo.vTotal >> modeInfo.modeFlags;
+            modeInfos.push_back(modeInfo);
+        } else if (type == "crtc") {
+            CrtcRecord crtc;
+            in >> crtc.id >> crtc.x >> crtc.y >> crtc.width >> crtc.height >> crtc.mode >> crtc.rotation
+               >> crtc.rotations;
+            readList(in, &crtc.outputs);
+            readList(in, &crtc.possible);
+            crtcs.push_back(crtc);
+        } else if (type == "output") {
+            OutputRecord output;
+            in >> output.id >> output.name >> output.connection >> output.crtc >> output.mmWidth >> output.mmHeight
+               >> output.npreferred;
+            readList(in, &output.crtcs);
+            readList(in, &output.clones);
+            readList(in, &output.modes);
+            outputs.push_back(output);
+        } else if (type == "edid") {
+            RROutput id = 0;
+            in >> id;
+            OutputRecord *output = outputRecord(id);
+            if (!output)
+                throw invalid_argument("snapshot line " + to_string(number) + " has EDID for unknown output " +
+                                       to_string(id));
+            output->edid.clear();
+            readHex(in, &output->edid);
+            if (in && output->edid.size() < EDID_MIN_LENGTH)
+                throw invalid_argument("snapshot line " + to_string(number) + " has EDID size " +
+                                       to_string(output->edid.size()) + ", expected at least " +
+                                       to_string(EDID_MIN_LENGTH));
+        } else {
+            throw invalid_argument("snapshot line " + to_string(number) + " has unknown record '" + type + "'");
+        }
+
+        // nothing may be missing or left over
+        string extra;
+        if (in.fail() || in >> extra)
+            throw invalid_argument("snapshot line " + to_string(number) + " is malformed: '" + line + "'");
+    }
+}
+
+SnapshotBackend::SnapshotBackend(const shared_ptr<Session> &session, const bool &probe, const bool &laptopLidClosed) :
+        lidClosed(laptopLidClosed) {
+    xcb_connection_t *conn = session->conn;
+    const xcb_window_t root = (xcb_window_t) session->root;
+
+    // screen size and limits, collected alongside the RandR state
+    const xcb_randr_get_screen_size_range_cookie_t sizeRangeCookie = xcb_randr_get_screen_size_range(conn, root);
+    const xcb_get_geometry_cookie_t geometryCookie = xcb_get_geometry(conn, root);
+    const RandrState state(conn, session->atoms, session->traffic, root, probe);
+    const XcbReply<xcb_randr_get_screen_size_range_reply_t> sizeRange(
+            xcb_randr_get_screen_size_range_reply(conn, sizeRangeCookie, nullptr), free);
+    const XcbReply<xcb_get_geometry_reply_t> geometry(xcb_get_geometry_reply(conn, geometryCookie, nullptr), free);
+    if (!sizeRange || !geometry)
+        throw runtime_error("unable to retrieve screen size");
+    width = geometry->width;
+    height = geometry->height;
+    minWidth = sizeRange->min_width;
+    minHeight = sizeRange->min_height;
+    maxWidth = sizeRange->max_width;
+    maxHeight = sizeRange->max_height;
+    mmWidth = (unsigned int) DisplayWidthMM(session->dpy, DefaultScreen(session->dpy));
+    mmHeight = (unsigned int) DisplayHeightMM(session->dpy, DefaultScreen(session->dpy));
+    primary = state.primary;
+
+    const XRRScreenResources *resources = state.resources();
+    for (int i = 0; i < resources->nmode; i++) {
+        XRRModeInfo modeInfo = resources->modes[i];
+        modeInfo.name = nullptr;
+        modeInfo.nameLength = 0;
+        modeInfos.push_back(modeInfo);
+    }
+
+    for (int i = 0; i < resources->ncrtc; i++) {
+        const XRRCrtcInfo *crtcInfo = state.crtcInfo(resources->crtcs[i]);
+        if (!crtcInfo)
+            continue;
+        CrtcRecord crtc;
+        crtc.id = resources->crtcs[i];
+        crtc.x = crtcInfo->x;
+        crtc.y = crtcInfo->y;
+        crtc.width = crtcInfo->width;
+        crtc.height = crtcInfo->height;
+        crtc.mode = crtcInfo->mode;
+        crtc.rotation = crtcInfo->rotation;
+        crtc.rotations = crtcInfo->rotations;
+        crtc.outputs.assign(crtcInfo->outputs, crtcInfo->outputs + crtcInfo->noutput);
+        crtc.possible.assign(crtcInfo->possible, crtcInfo->possible + crtcInfo->npossible);
+        crtcs.push_back(crtc);
+    }
+
+    // the EDID of all connected outputs is requested before any are waited for
+    const shared_ptr<EdidBatch> batch = make_shared<EdidBatch>(session, state.edidAtom);
+    vector<Lazy<const Edid>> edids((size_t) resources->noutput);
+    for (int i = 0; i < resources->noutput; i++) {
+        const XRROutputInfo *outputInfo = state.outputInfo(i);
+        OutputRecord output;
+        output.id = resources->outputs[i];
+        output.name = outputInfo->name;
+        output.connection = outputInfo->connection;
+        output.crtc = outputInfo->crtc;
+        output.mmWidth = outputInfo->mm_width;
+        output.mmHeight = outputInfo->mm_height;
+        output.npreferred = outputInfo->npreferred;
+        output.crtcs.assign(outputInfo->crtcs, outputInfo->crtcs + outputInfo->ncrtc);
+        output.clones.assign(outputInfo->clones, outputInfo->clones + outputInfo->nclone);
+        output.modes.assign(outputInfo->modes, outputInfo->modes + outputInfo->nmode);
+        outputs.push_back(output);
+
+        if (outputInfo->connection != RR_Disconnected) {
+            edids[(size_t) i] = lazyEdid(batch, output.id, output.name);
+            edids[(size_t) i].request();
+        }
+    }
+    for (size_t i = 0; i < outputs.size(); i++) {
+        // an EDID too short to use is not recorded
+        try {
+            if (edids[i])
+                outputs[i].edid.assign(edids[i]->data(), edids[i]->data() + edids[i]->length);
+        } catch (const invalid_argument &) {
+        }
+    }
+}
+
+void SnapshotBackend::write(ostream &snapshot) const {
+    snapshot << "# xlayoutdisplay snapshot\n";
+    snapshot << "lid " << (lidClosed ? "closed" : "open") << '\n';
+    snapshot << "screen " << width << ' ' << height << ' ' << minWidth << ' ' << minHeight << ' ' << maxWidth << ' '
+             << maxHeight << ' ' << mmWidth << ' ' << mmHeight << '\n';
+    snapshot << "primary " << primary << '\n';
+    for (const auto &modeInfo : modeInfos) {
+        snapshot << "mode " << modeInfo.id << ' ' << modeInfo.width << ' ' << modeInfo.height << ' '
+                 << modeInfo.dotClock << ' ' << modeInfo.hSyncStart << ' ' << modeInfo.hSyncEnd << ' '
+                 << modeInfo.hTotal << ' ' << modeInfo.hSkew << ' ' << modeInfo.vSyncStart << ' '
+                 << modeInfo.vSyncEnd << ' ' << modeInfo.vTotal << ' ' << modeInfo.modeFlags << '\n';
+    }
+    for (const auto &crtc : crtcs) {
+        snapshot << "crtc " << crtc.id << ' ' << crtc.x << ' ' << crtc.y << ' ' << crtc.width << ' ' << crtc.height
+                 << ' ' << crtc.mode << ' ' << crtc.rotation << ' ' << crtc.rotations;
+        writeList(snapshot, crtc.outputs);
+        writeList(snapshot, crtc.possible);
+        snapshot << '\n';
+    }
+    for (const auto &output : outputs) {
+        snapshot << "output " << output.id << ' ' << output.name << ' ' << output.connection << ' ' << output.crtc
+                 << ' ' << output.mmWidth << ' ' << output.mmHeight << ' ' << output.npreferred;
+        writeList(snapshot, output.crtcs);
+        writeList(snapshot, output.clones);
+        writeList(snapshot, output.modes);
+        snapshot << '\n';
+    }
+    for (const auto &output : outputs) {
+        if (output.edid.empty())
+            continue;
+        snapshot << "edid " << output.id << ' ' << hex << setfill('0');
+        for (const auto &byte : output.edid)
+            snapshot << setw(2) << (unsigned int) byte;
+        snapshot << dec << setfill(' ') << '\n';
+    }
+}
+
+const list<shared_ptr<Output>> SnapshotBackend::discover(const bool &, string *explaination) {
+    stringstream verbose;
+
+    const auto start = chrono::steady_clock::now();
+
+    const list<shared_ptr<Output>> discovered = build();
+
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    verbose << "replayed snapshot; discovered " << discovered.size() << " outputs in " << fixed << setprecision(1)
+            << elapsed.count() << "ms";
+    *explaination = verbose.str();
+
+    return discovered;
+}
+
+const list<shared_ptr<Output>> SnapshotBackend::rediscover(const list<shared_ptr<Output>> &previous,
+                                                           const set<RROutput> &changed, string *explaination) {
+    list<shared_ptr<Output>> rediscovered;
+    stringstream verbose;
+
+    const auto start = chrono::steady_clock::now();
+
+    map<RROutput, shared_ptr<Output>> reusable;
+    for (const auto &output : previous)
+        if (!changed.count(output->rrOutput))
+            reusable[output->rrOutput] = output;
+
+    unsigned int queried = 0;
+    for (const auto &output : build()) {
+        const auto reused = reusable.find(output->rrOutput);
+        if (reused == reusable.end()) {
+            rediscovered.push_back(output);
+            queried++;
+        } else {
+            reused->second->resetDesired();
+            reused->second->currentPrimary = output->currentPrimary;
+            rediscovered.push_back(reused->second);
+        }
+    }
+
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    verbose << "rediscovered " << queried << " of " << rediscovered.size() << " outputs in " << fixed
+            << setprecision(1) << elapsed.count() << "ms";
+    *explaination = verbose.str();
+
+    return rediscovered;
+}
+
+const list<shared_ptr<Output>> SnapshotBackend::build() {
+    list<shared_ptr<Output>> built;
+
+    // Xrandr structures viewing the records, as RandrState presents them
+    vector<RRCrtc> crtcIds;
+    vector<XRRCrtcInfo> crtcInfos;
+    for (auto &crtc : crtcs) {
+        crtcIds.push_back(crtc.id);
+        XRRCrtcInfo crtcInfo{};
+        crtcInfo.x = crtc.x;
+        crtcInfo.y = crtc.y;
+        crtcInfo.width = crtc.width;
+        crtcInfo.height = crtc.height;
+        crtcInfo.mode = crtc.mode;
+        crtcInfo.rotation = crtc.rotation;
+        crtcInfo.rotations = crtc.rotations;
+        crtcInfo.noutput = (int) crtc.outputs.size();
+        crtcInfo.outputs = crtc.outputs.data();
+        crtcInfo.npossible = (int) crtc.possible.size();
+        crtcInfo.possible = crtc.possible.data();
+        crtcInfos.push_back(crtcInfo);
+    }
+    vector<RROutput> outputIds;
+    for (const auto &output : outputs)
+        outputIds.push_back(output.id);
+    XRRScreenResources resources{};
+    resources.ncrtc = (int) crtcIds.size();
+    resources.crtcs = crtcIds.data();
+    resources.noutput = (int) outputIds.size();
+    resources.outputs = outputIds.data();
+    resources.nmode = (int) modeInfos.size();
+    resources.modes = modeInfos.data();
+
+    ModeIndex modeIndex(&resources);
+    for (auto &output : outputs) {
+        XRROutputInfo outputInfo{};
+        outputInfo.crtc = output.crtc;
+        outputInfo.name = &output.name[0];
+        outputInfo.nameLen = (int) output.name.size();
+        outputInfo.mm_width = output.mmWidth;
+        outputInfo.mm_height = output.mmHeight;
+        outputInfo.connection = output.connection;
+        outputInfo.ncrtc = (int) output.crtcs.size();
+        outputInfo.crtcs = output.crtcs.data();
+        outputInfo.nclone = (int) output.clones.size();
+        outputInfo.clones = output.clones.data();
+        outputInfo.nmode = (int) output.modes.size();
+        outputInfo.npreferred = output.npreferred;
+        outputInfo.modes = output.modes.data();
+
+        const XRRCrtcInfo *crtcInfo = nullptr;
+        for (size_t i = 0; i < crtcIds.size(); i++)
+            if (crtcIds[i] == output.crtc)
+                crtcInfo = &crtcInfos[i];
+
+        // disconnected outputs have no Edid, as when discovering from X
+        Lazy<const Edid> edid;
+        if (output.connection != RR_Disconnected && !output.edid.empty())
+            edid = make_shared<const Edid>(output.edid.data(), output.edid.size(), output.name.c_str());
+
+        const shared_ptr<Output> rebuilt = outputFromXRR(modeIndex, output.id, &outputInfo, crtcInfo, edid);
+        rebuilt->currentPrimary = rebuilt->rrOutput == primary;
+        built.push_back(rebuilt);
+    }
+
+    return built;
+}
+
+void SnapshotBackend::apply(const list<shared_ptr<Output>> &outputs, const shared_ptr<Output> &primary,
+                            const long &dpi, const long &rate) {
+    // what will be applied
+    const pair<unsigned int, unsigned int> screenSize = calculateScreenSize(outputs);
+    if (screenSize.first == 0 || screenSize.second == 0)
+        throw invalid_argument("apply received no desired active outputs");
+    const unsigned int newWidth = max(screenSize.first, minWidth);
+    const unsigned int newHeight = max(screenSize.second, minHeight);
+    if (newWidth > maxWidth || newHeight > maxHeight)
+        throw runtime_error("screen size " + to_string(newWidth) + "x" + to_string(newHeight) + " exceeds maximum " +
+                            to_string(maxWidth) + "x" + to_string(maxHeight));
+    const pair<unsigned int, unsigned int> mm = calculateScreenMm(make_pair(newWidth, newHeight), dpi);
+
+    // disable CRTCs that are no longer wanted or that will not fit the new screen
+    // a CRTC that an output leaves while another keeps it is instead reconfigured with its remaining outputs
+    const vector<vector<shared_ptr<Output>>> groups = crtcGroups(outputs);
+    set<RRCrtc> disabled, vacated;
+    for (const auto &output : outputs) {
+        if (!output->crtc || !output->currentMode || !output->currentPos)
+            continue;
+        const bool off = calculateChange(output, rate) == Output::disable || output->desiredCrtc != output->crtc;
+        const pair<unsigned int, unsigned int> currentArea = output->currentArea();
+        const bool outside = output->currentPos->x + currentArea.first > newWidth ||
+                             output->currentPos->y + currentArea.second > newHeight;
+        if (!off && !outside)
+            continue;
+        const bool kept = any_of(groups.begin(), groups.end(), [&output](const vector<shared_ptr<Output>> &group) {
+            return group.front()->desiredCrtc == output->crtc;
+        });
+        if (kept && !outside) {
+            vacated.insert(output->crtc);
+            continue;
+        }
+        disabled.insert(output->crtc);
+        CrtcRecord *crtc = crtcRecord(output->crtc);
+        if (!crtc)
+            throw runtime_error("unable to configure CRTC for output " + output->name);
+        for (const auto &id : crtc->outputs) {
+            OutputRecord *occupant = outputRecord(id);
+            if (occupant)
+                occupant->crtc = 0;
+        }
+        crtc->x = 0;
+        crtc->y = 0;
+        crtc->width = 0;
+        crtc->height = 0;
+        crtc->mode = 0;
+        crtc->rotation = RR_Rotate_0;
+        crtc->outputs.clear();
+    }
+
+    // resize the screen
+    width = newWidth;
+    height = newHeight;
+    mmWidth = mm.first;
+    mmHeight = mm.second;
+
+    // enable CRTCs, leaving those with all outputs already in their desired state alone
+    for (const auto &group : groups) {
+        const shared_ptr<Output> &output = group.front();
+        if (!output->desiredMode || !output->desiredPos)
+            continue;
+        if (!disabled.count(output->desiredCrtc) && !vacated.count(output->desiredCrtc) &&
+            all_of(group.begin(), group.end(), [&rate](const shared_ptr<Output> &member) {
+                return calculateChange(member, rate) == Output::unchanged;
+            }))
+            continue;
+        const shared_ptr<const Mode> mode = rate ? calculateRateMode(output, rate) : output->desiredMode;
+        CrtcRecord *crtc = crtcRecord(output->desiredCrtc);
+        vector<OutputRecord *> records;
+        for (const auto &member : group) {
+            OutputRecord *record = outputRecord(member->rrOutput);
+            if (!crtc || !record || find(record->crtcs.begin(), record->crtcs.end(), crtc->id) == record->crtcs.end())
+                throw runtime_error("unable to configure CRTC for output " + member->name);
+            for (const auto &other : records)
+                if (find(record->clones.begin(), record->clones.end(), other->id) == record->clones.end() ||
+                    find(other->clones.begin(), other->clones.end(), record->id) == other->clones.end())
+                    throw runtime_error("unable to configure CRTC for output " + member->name);
+            records.push_back(record);
+        }
+        const pair<unsigned int, unsigned int> area = output->desiredArea();
+        crtc->x = output->desiredPos->x;
+        crtc->y = output->desiredPos->y;
+        crtc->width = area.first;
+        crtc->height = area.second;
+        crtc->mode = mode->rrMode;
+        crtc->rotation = RR_Rotate_0;
+        for (const auto &id : crtc->outputs) {
+            OutputRecord *occupant = outputRecord(id);
+            if (occupant && occupant->crtc == crtc->id)
+                occupant->crtc = 0;
+        }
+        crtc->outputs.clear();
+        for (const auto &record : records) {
+            crtc->outputs.push_back(record->id);
+            record->crtc = crtc->id;
+        }
+    }
+
+    if (primary)
+        this->primary = primary->rrOutput;
+}
+
+bool SnapshotBackend::applyXftDpi(const long &dpi) {
+    const string merged = mergeXftDpi(xResources, dpi);
+    if (merged == xResources)
+        return false;
+    xResources = merged;
+    return true;
+}
+
+void SnapshotBackend::resetRootCursor() {
+}
+
+SnapshotBackend::OutputRecord *SnapshotBackend::outputRecord(const RROutput &id) {
+    for (auto &output : outputs)
+        if (output.id == id)
+            return &output;
+    return nullptr;
+}
+
+SnapshotBackend::CrtcRecord *SnapshotBackend::crtcRecord(const RRCrtc &id) {
+    for (auto &crtc : crtcs)
+        if (crtc.id == id)
+            return &crtc;
+    return nullptr;
+}
+
+void recordSnapshot(const string &path, const bool &probe) {
+    const SnapshotBackend snapshot(make_shared<Session>(), probe, calculateLaptopLidClosed(LAPTOP_LID_ROOT_PATH));
+    ofstream out(path);
+    snapshot.write(out);
+    out.close();
+    if (!out)
+        throw runtime_error("unable to write snapshot '" + path + "'");
+}
@@ -0,0 +1,149 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_SNAPSHOTBACKEND_H
+#define XLAYOUTDISPLAY_SNAPSHOTBACKEND_H
+
+#include "Backend.h"
+#include "Session.h"
+
+#include <X11/extensions/Xrandr.h>
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// a recorded X server held in memory, so that layout may be replayed without one
+// apply changes the recorded state, which is seen by the next discovery
+//
+// snapshots are text, one record per line, with counted lists and hex EDID; blank lines and those starting with #
+// are ignored:
+//   lid <open|closed>
+//   screen <width> <height> <minWidth> <minHeight> <maxWidth> <maxHeight> [<mmWidth> <mmHeight>]
+//   primary <output>
+//   mode <id> <width> <height> <dotClock> <hSyncStart> <hSyncEnd> <hTotal> <hSkew> <vSyncStart> <vSyncEnd> <vTotal> <modeFlags>
+//   crtc <id> <x> <y> <width> <height> <mode> <rotation> <rotations> <n> <outputs...> <n> <possible...>
+//   output <id> <name> <connection> <crtc> <mmWidth> <mmHeight> <npreferred> <n> <crtcs...> <n> <clones...> <n> <modes...>
+//   edid <output> <hex>
+class SnapshotBackend : public Backend {
+public:
+    // throws invalid_argument:
+    //   malformed snapshot
+    explicit SnapshotBackend(std::istream &snapshot);
+
+    // capture the state of X via session, polling the hardware when probe is set, with the EDID of all connected
+    // outputs
+    // throws runtime_error:
+    //   when RandR requests fail
+    SnapshotBackend(const std::shared_ptr<Session> &session, const bool &probe, const bool &laptopLidClosed);
+
+    // write the current state, as read by the constructor
+    void write(std::ostream &snapshot) const;
+
+    // throws invalid_argument:
+    //   recorded output or CRTC mode not found
+    const std::list<std::shared_ptr<Output>> discover(const bool &probe, std::string *explaination) override;
+
+    const std::list<std::shared_ptr<Output>> rediscover(const std::list<std::shared_ptr<Output>> &previous,
+                                                        const std::set<RROutput> &changed,
+                                                        std::string *explaination) override;
+
+    bool laptopLidClosed() const override { return lidClosed; }
+
+    const std::pair<unsigned int, unsigned int> screenSize() const override { return std::make_pair(width, height); }
+
+    const std::pair<unsigned int, unsigned int> screenMm() const override { return std::make_pair(mmWidth, mmHeight); }
+
+    // validated as per applyOutputs; a scaled CRTC covers the area it is scaled from, as it does in X
+    // throws invalid_argument:
+    //   no desired active outputs
+    // throws runtime_error:
+    //   screen too large
+    //   CRTC not present or not possible for an output
+    void apply(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary,
+               const long &dpi, const long &rate) override;
+
+    // updates resources
+    bool applyXftDpi(const long &dpi) override;
+
+    // nothing to reset
+    void resetRootCursor() override;
+
+    // none, as there is no X server
+    XTraffic::Counts traffic() const override { return XTraffic::Counts(); }
+
+    // resource manager contents, initially empty
+    const std::string &resources() const { return xResources; }
+
+private:
+    struct OutputRecord {
+        RROutput id = 0;
+        std::string name;
+        Connection connection = RR_Disconnected;
+        RRCrtc crtc = 0;
+        unsigned long mmWidth = 0;
+        unsigned long mmHeight = 0;
+        int npreferred = 0;
+        std::vector<RRCrtc> crtcs;
+        std::vector<RROutput> clones;
+        std::vector<RRMode> modes;
+        std::vector<unsigned char> edid;
+    };
+
+    struct CrtcRecord {
+        RRCrtc id = 0;
+        int x = 0;
+        int y = 0;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        RRMode mode = 0;
+        Rotation rotation = RR_Rotate_0;
+        Rotation rotations = RR_Rotate_0;
+        std::vector<RROutput> outputs;
+        std::vector<RROutput> possible;
+    };
+
+    // Outputs from the records
+    const std::list<std::shared_ptr<Output>> build();
+
+    OutputRecord *outputRecord(const RROutput &id);
+
+    CrtcRecord *crtcRecord(const RRCrtc &id);
+
+    bool lidClosed = false;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int minWidth = 0;
+    unsigned int minHeight = 0;
+    unsigned int maxWidth = 0;
+    unsigned int maxHeight = 0;
+    unsigned int mmWidth = 0;
+    unsigned int mmHeight = 0;
+    RROutput primary = 0;
+    std::vector<XRRModeInfo> modeInfos;
+    std::vector<CrtcRecord> crtcs;
+    std::vector<OutputRecord> outputs;
+    std::string xResources;
+};
+
+// record the state of X and the laptop lid to path, polling the hardware when probe is set
+// throws runtime_error:
+//   unable to write path
+//   when RandR requests fail
+void recordSnapshot(const std::string &path, const bool &probe);
+
+#endif //XLAYOUTDISPLAY_SNAPSHOTBACKEND_H
@@ -0,0 +1,99 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Timings.h"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static void renderJson(ostream &os, const XTraffic::Counts &traffic) {
+    os << "{\"requests\": " << traffic.requests << ", \"roundTrips\": " << traffic.roundTrips
+       << ", \"bytesSent\": " << traffic.bytesSent << ", \"bytesReceived\": " << traffic.bytesReceived << "}";
+}
+
+static void renderText(ostream &os, const string &name, const chrono::nanoseconds &elapsed,
+                       const XTraffic::Counts *traffic) {
+    os << "\n  " << left << setw(10) << name << right << setw(10) << chrono::duration<double, milli>(elapsed).count();
+    if (traffic)
+        os << setw(10) << traffic->requests << setw(6) << traffic->roundTrips << setw(10) << traffic->bytesSent
+           << setw(10) << traffic->bytesReceived;
+}
+
+Timings::Timings(const string &format) : format(parseFormat(format)) {
+}
+
+Timings::Format Timings::parseFormat(const string &format) {
+    if (format.empty())
+        return none;
+    if (format == "text")
+        return text;
+    if (format == "json")
+        return json;
+    throw invalid_argument("unknown timings format '" + format + "', expected text or json");
+}
+
+void Timings::add(const string &name, const chrono::nanoseconds &elapsed, const XTraffic::Counts &traffic) {
+    for (auto &phase : phases) {
+        if (phase.name == name) {
+            phase.elapsed += elapsed;
+            phase.traffic += traffic;
+            return;
+        }
+    }
+    phases.push_back({name, elapsed, traffic});
+}
+
+const string Timings::render() const {
+    if (format == none)
+        return string();
+
+    chrono::nanoseconds total(0);
+    XTraffic::Counts totalTraffic;
+    for (const auto &phase : phases) {
+        total += phase.elapsed;
+        totalTraffic += phase.traffic;
+    }
+
+    stringstream ss;
+    ss << fixed << setprecision(3);
+    if (format == json) {
+        ss << "{\"phases\": {";
+        for (auto phase = phases.begin(); phase != phases.end(); phase++)
+            ss << (phase == phases.begin() ? "" : ", ") << '"' << phase->name << "\": "
+               << chrono::duration<double, milli>(phase->elapsed).count();
+        ss << "}, \"total\": " << chrono::duration<double, milli>(total).count();
+        if (counter) {
+            ss << ", \"traffic\": {";
+            for (const auto &phase : phases) {
+                ss << '"' << phase.name << "\": ";
+                renderJson(ss, phase.traffic);
+                ss << ", ";
+            }
+            ss << "\"total\": ";
+            renderJson(ss, totalTraffic);
+            ss << "}";
+        }
+        ss << "}";
+    } else {
+        ss << (counter ? "timings (ms) and X requests, round trips, bytes sent, bytes received:" : "timings (ms):");
+        for (const auto &phase : phases)
+            renderText(ss, phase.name, phase.elapsed, counter ? &phase.traffic : nullptr);
+        renderText(ss, "total", total, counter ? &totalTraffic : nullptr);
+    }
+    return ss.str();
+}
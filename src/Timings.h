@@ -0,0 +1,113 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_TIMINGS_H
+#define XLAYOUTDISPLAY_TIMINGS_H
+
+#include "XTraffic.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// monotonic time taken by the named phases of a layout, and optionally their X traffic, reported in the order that
+// they first ran
+// when disabled nothing is measured or kept
+class Timings {
+public:
+    enum Format {
+        none, text, json
+    };
+
+    // measures a phase from construction until stopped, replaced by another phase or destroyed
+    class Phase {
+    public:
+        Phase(Phase &&o) noexcept : timings(o.timings), name(o.name), start(o.start), traffic(o.traffic) {
+            o.timings = nullptr;
+        }
+
+        Phase(const Phase &) = delete;
+
+        Phase &operator=(Phase &&o) noexcept {
+            stop();
+            timings = o.timings;
+            name = o.name;
+            start = o.start;
+            traffic = o.traffic;
+            o.timings = nullptr;
+            return *this;
+        }
+
+        Phase &operator=(const Phase &) = delete;
+
+        ~Phase() { stop(); }
+
+        // no effect when already stopped
+        void stop() {
+            if (timings)
+                timings->add(name, std::chrono::steady_clock::now() - start,
+                             timings->counter ? timings->counter() - traffic : XTraffic::Counts());
+            timings = nullptr;
+        }
+
+    private:
+        friend class Timings;
+
+        Phase(Timings *timings, const char *name) :
+                timings(timings), name(name),
+                start(timings ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()),
+                traffic(timings && timings->counter ? timings->counter() : XTraffic::Counts()) {}
+
+        Timings *timings;
+        const char *name;
+        std::chrono::steady_clock::time_point start;
+        XTraffic::Counts traffic;
+    };
+
+    // format is empty for none, "text" or "json"
+    // throws invalid_argument:
+    //   unknown format
+    explicit Timings(const std::string &format);
+
+    // measure name until the returned Phase is destroyed
+    Phase phase(const char *name) { return Phase(format == none ? nullptr : this, name); }
+
+    // also report the X traffic of each phase, as the difference in counter
+    void countTraffic(const std::function<XTraffic::Counts()> &counter) { this->counter = counter; }
+
+    // add elapsed and traffic to name, which is appended when new
+    void add(const std::string &name, const std::chrono::nanoseconds &elapsed,
+             const XTraffic::Counts &traffic = XTraffic::Counts());
+
+    // phases then their total, in milliseconds, with their X traffic when counted; empty when none
+    const std::string render() const;
+
+    const Format format;
+
+private:
+    struct Entry {
+        std::string name;
+        std::chrono::nanoseconds elapsed;
+        XTraffic::Counts traffic;
+    };
+
+    static Format parseFormat(const std::string &format);
+
+    std::function<XTraffic::Counts()> counter;
+    std::vector<Entry> phases;
+};
+
+#endif //XLAYOUTDISPLAY_TIMINGS_H
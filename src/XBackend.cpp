@@ -0,0 +1,62 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "XBackend.h"
+
+#include "apply.h"
+#include "Monitors.h"
+#include "xrandrrutil.h"
+#include "xrdbutil.h"
+#include "xutil.h"
+
+using namespace std;
+
+const list<shared_ptr<Output>> XBackend::discover(const bool &probe, string *explaination) {
+    return discoverOutputs(session, probe, explaination);
+}
+
+const list<shared_ptr<Output>> XBackend::rediscover(const list<shared_ptr<Output>> &previous,
+                                                    const set<RROutput> &changed, string *explaination) {
+    return rediscoverOutputs(session, previous, changed, explaination);
+}
+
+bool XBackend::laptopLidClosed() const {
+    return calculateLaptopLidClosed(LAPTOP_LID_ROOT_PATH);
+}
+
+const pair<unsigned int, unsigned int> XBackend::screenSize() const {
+    const int screen = DefaultScreen(session->dpy);
+    return make_pair((unsigned int) DisplayWidth(session->dpy, screen),
+                     (unsigned int) DisplayHeight(session->dpy, screen));
+}
+
+const pair<unsigned int, unsigned int> XBackend::screenMm() const {
+    const int screen = DefaultScreen(session->dpy);
+    return make_pair((unsigned int) DisplayWidthMM(session->dpy, screen),
+                     (unsigned int) DisplayHeightMM(session->dpy, screen));
+}
+
+void XBackend::apply(const list<shared_ptr<Output>> &outputs, const shared_ptr<Output> &primary, const long &dpi,
+                     const long &rate) {
+    applyOutputs(session, outputs, primary, dpi, rate);
+}
+
+bool XBackend::applyXftDpi(const long &dpi) {
+    return ::applyXftDpi(session, dpi);
+}
+
+void XBackend::resetRootCursor() {
+    ::resetRootCursor(session);
+}
@@ -0,0 +1,55 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_XBACKEND_H
+#define XLAYOUTDISPLAY_XBACKEND_H
+
+#include "Backend.h"
+#include "Session.h"
+
+#include <memory>
+
+// a live X server, via session
+class XBackend : public Backend {
+public:
+    explicit XBackend(const std::shared_ptr<Session> &session) : session(session) {}
+
+    const std::list<std::shared_ptr<Output>> discover(const bool &probe, std::string *explaination) override;
+
+    const std::list<std::shared_ptr<Output>> rediscover(const std::list<std::shared_ptr<Output>> &previous,
+                                                        const std::set<RROutput> &changed,
+                                                        std::string *explaination) override;
+
+    // read from LAPTOP_LID_ROOT_PATH
+    bool laptopLidClosed() const override;
+
+    // as last seen by Xlib, which is kept current by XRRUpdateConfiguration
+    const std::pair<unsigned int, unsigned int> screenSize() const override;
+
+    const std::pair<unsigned int, unsigned int> screenMm() const override;
+
+    void apply(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary,
+               const long &dpi, const long &rate) override;
+
+    bool applyXftDpi(const long &dpi) override;
+
+    void resetRootCursor() override;
+
+    XTraffic::Counts traffic() const override { return session->traffic.counts(); }
+
+    const std::shared_ptr<Session> session;
+};
+
+#endif //XLAYOUTDISPLAY_XBACKEND_H
@@ -0,0 +1,72 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "XTraffic.h"
+
+using namespace std;
+
+XTraffic::Counts XTraffic::Counts::operator-(const Counts &o) const {
+    Counts difference;
+    difference.requests = requests - o.requests;
+    difference.roundTrips = roundTrips - o.roundTrips;
+    difference.bytesSent = bytesSent - o.bytesSent;
+    difference.bytesReceived = bytesReceived - o.bytesReceived;
+    return difference;
+}
+
+XTraffic::Counts &XTraffic::Counts::operator+=(const Counts &o) {
+    requests += o.requests;
+    roundTrips += o.roundTrips;
+    bytesSent += o.bytesSent;
+    bytesReceived += o.bytesReceived;
+    return *this;
+}
+
+void XTraffic::sentSequence(const unsigned int &sequence) {
+    if (!anySent) {
+        anySent = true;
+        requests = 1;
+        lastSent = sequence;
+        inFlight = sequence - 1;
+        return;
+    }
+
+    // the difference is that of the low 32 bits, which survives wrapping
+    const auto ahead = (int) (sequence - lastSent);
+    if (ahead > 0) {
+        requests += (unsigned int) ahead;
+        lastSent = sequence;
+    }
+}
+
+void XTraffic::awaitingSequence(const unsigned int &sequence) {
+    if ((int) (sequence - inFlight) > 0) {
+        roundTrips++;
+
+        // everything sent so far is flushed by the wait
+        inFlight = (int) (sequence - lastSent) > 0 ? sequence : lastSent;
+    }
+}
+
+XTraffic::Counts XTraffic::counts() const {
+    Counts counts;
+    counts.requests = requests;
+    counts.roundTrips = roundTrips;
+    if (conn) {
+        counts.bytesSent = xcb_total_written(conn);
+        counts.bytesReceived = xcb_total_read(conn);
+    }
+    return counts;
+}
@@ -0,0 +1,75 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_XTRAFFIC_H
+#define XLAYOUTDISPLAY_XTRAFFIC_H
+
+#include <xcb/xcb.h>
+
+#include <cstdint>
+
+// X protocol requests and round trips made on a connection, counted by request sequence number as requests are sent
+// and their replies waited for
+// waiting for a reply costs a round trip unless the request was sent before the previous round trip began, as its
+// reply is then already on its way; pipelined requests therefore cost a single round trip
+class XTraffic {
+public:
+    struct Counts {
+        unsigned long requests = 0;
+        unsigned long roundTrips = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+
+        Counts operator-(const Counts &o) const;
+
+        Counts &operator+=(const Counts &o);
+    };
+
+    // bytes are those of conn as a whole, none when nullptr
+    explicit XTraffic(xcb_connection_t *conn = nullptr) : conn(conn) {}
+
+    // a request has been sent, along with any unseen requests since the last
+    template<typename Cookie>
+    const Cookie &sent(const Cookie &cookie) {
+        sentSequence(cookie.sequence);
+        return cookie;
+    }
+
+    // about to wait for the reply to, or error from, a request
+    template<typename Cookie>
+    const Cookie &awaiting(const Cookie &cookie) {
+        awaitingSequence(cookie.sequence);
+        return cookie;
+    }
+
+    // sequence numbers wrap at 32 bits, as per xcb
+    void sentSequence(const unsigned int &sequence);
+
+    void awaitingSequence(const unsigned int &sequence);
+
+    // since construction
+    Counts counts() const;
+
+private:
+    xcb_connection_t *conn;
+
+    bool anySent = false;
+    unsigned int lastSent = 0;
+    unsigned int inFlight = 0;
+    unsigned long requests = 0;
+    unsigned long roundTrips = 0;
+};
+
+#endif //XLAYOUTDISPLAY_XTRAFFIC_H
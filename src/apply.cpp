@@ -0,0 +1,194 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "apply.h"
+#include "calculations.h"
+#include "xcbrandrutil.h"
+
+#include <xcb/randr.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// 16.16 fixed point
+#define FIXED_ONE 65536
+
+// scales mode up or down to the output's desired area, the identity when unscaled
+static xcb_render_transform_t scaleTransform(const shared_ptr<Output> &output, const shared_ptr<const Mode> &mode) {
+    const pair<unsigned int, unsigned int> area = output->desiredArea();
+    xcb_render_transform_t transform{};
+    transform.matrix11 = (xcb_render_fixed_t) lround((double) FIXED_ONE * area.first / mode->width);
+    transform.matrix22 = (xcb_render_fixed_t) lround((double) FIXED_ONE * area.second / mode->height);
+    transform.matrix33 = FIXED_ONE;
+    return transform;
+}
+
+void applyOutputs(const shared_ptr<Session> &session, const list<shared_ptr<Output>> &outputs,
+                  const shared_ptr<Output> &primary, const long &dpi, const long &rate) {
+    xcb_connection_t *conn = session->conn;
+    XTraffic &traffic = session->traffic;
+    const xcb_window_t root = (xcb_window_t) session->root;
+
+    // what will be applied
+    const pair<unsigned int, unsigned int> screenSize = calculateScreenSize(outputs);
+    if (screenSize.first == 0 || screenSize.second == 0)
+        throw invalid_argument("applyOutputs received no desired active outputs");
+
+    // config timestamp and screen limits
+    const xcb_randr_get_screen_resources_current_cookie_t resourcesCookie =
+            traffic.sent(xcb_randr_get_screen_resources_current(conn, root));
+    const xcb_randr_get_screen_size_range_cookie_t sizeRangeCookie =
+            traffic.sent(xcb_randr_get_screen_size_range(conn, root));
+    const xcb_get_geometry_cookie_t geometryCookie = traffic.sent(xcb_get_geometry(conn, root));
+    const XcbReply<xcb_randr_get_screen_resources_current_reply_t> resources(
+            xcb_randr_get_screen_resources_current_reply(conn, traffic.awaiting(resourcesCookie), nullptr), free);
+    const XcbReply<xcb_randr_get_screen_size_range_reply_t> sizeRange(
+            xcb_randr_get_screen_size_range_reply(conn, traffic.awaiting(sizeRangeCookie), nullptr), free);
+    const XcbReply<xcb_get_geometry_reply_t> geometry(
+            xcb_get_geometry_reply(conn, traffic.awaiting(geometryCookie), nullptr), free);
+    if (!resources || !sizeRange || !geometry)
+        throw runtime_error("unable to retrieve RandR screen resources");
+    const xcb_timestamp_t configTimestamp = resources->config_timestamp;
+
+    const unsigned int width = max(screenSize.first, (unsigned int) sizeRange->min_width);
+    const unsigned int height = max(screenSize.second, (unsigned int) sizeRange->min_height);
+    if (width > sizeRange->max_width || height > sizeRange->max_height)
+        throw runtime_error("screen size " + to_string(width) + "x" + to_string(height) + " exceeds maximum " +
+                            to_string(sizeRange->max_width) + "x" + to_string(sizeRange->max_height));
+    const pair<unsigned int, unsigned int> mm = calculateScreenMm(make_pair(width, height), dpi);
+    const Screen *screen = ScreenOfDisplay(session->dpy, DefaultScreen(session->dpy));
+    const bool resize = width != geometry->width || height != geometry->height ||
+                        (int) mm.first != screen->mwidth || (int) mm.second != screen->mheight;
+    const bool setPrimary = primary && !primary->currentPrimary;
+
+    // everything is sent within a grab, with replies collected afterwards so that the grab is always released
+    vector<pair<shared_ptr<Output>, xcb_randr_set_crtc_config_cookie_t>> crtcCookies;
+    vector<pair<shared_ptr<Output>, xcb_void_cookie_t>> transformCookies;
+    xcb_void_cookie_t screenSizeCookie{};
+    xcb_void_cookie_t primaryCookie{};
+    traffic.sent(xcb_grab_server(conn));
+
+    // disable CRTCs that are no longer wanted or that will not fit the new screen
+    // a CRTC that an output leaves while another keeps it is instead reconfigured with its remaining outputs
+    vector<vector<shared_ptr<Output>>> groups = crtcGroups(outputs);
+    set<RRCrtc> disabled, vacated;
+    for (const auto &output : outputs) {
+        if (!output->crtc || !output->currentMode || !output->currentPos)
+            continue;
+        const bool off = calculateChange(output, rate) == Output::disable || output->desiredCrtc != output->crtc;
+        const pair<unsigned int, unsigned int> currentArea = output->currentArea();
+        const bool outside = output->currentPos->x + currentArea.first > width ||
+                             output->currentPos->y + currentArea.second > height;
+        if (!off && !outside)
+            continue;
+        const bool kept = any_of(groups.begin(), groups.end(), [&output](const vector<shared_ptr<Output>> &group) {
+            return group.front()->desiredCrtc == output->crtc;
+        });
+        if (kept && !outside)
+            vacated.insert(output->crtc);
+        else if (disabled.insert(output->crtc).second)
+            crtcCookies.emplace_back(output, traffic.sent(
+                    xcb_randr_set_crtc_config(conn, (xcb_randr_crtc_t) output->crtc, XCB_CURRENT_TIME,
+                                              configTimestamp, 0, 0, XCB_NONE, XCB_RANDR_ROTATION_ROTATE_0, 0,
+                                              nullptr)));
+    }
+
+    // resize the screen
+    if (resize)
+        screenSizeCookie = traffic.sent(xcb_randr_set_screen_size_checked(
+                conn, root, (uint16_t) width, (uint16_t) height, mm.first, mm.second));
+
+    // enable CRTCs, leaving those with all outputs already in their desired state alone
+    // vacated CRTCs are first, releasing the outputs that leave them for their new CRTCs
+    stable_partition(groups.begin(), groups.end(), [&vacated](const vector<shared_ptr<Output>> &group) {
+        return vacated.count(group.front()->desiredCrtc) > 0;
+    });
+    for (const auto &group : groups) {
+        const shared_ptr<Output> &output = group.front();
+        if (!output->desiredMode || !output->desiredPos)
+            continue;
+        if (!disabled.count(output->desiredCrtc) && !vacated.count(output->desiredCrtc) &&
+            all_of(group.begin(), group.end(), [&rate](const shared_ptr<Output> &member) {
+                return calculateChange(member, rate) == Output::unchanged;
+            }))
+            continue;
+        const shared_ptr<const Mode> mode = rate ? calculateRateMode(output, rate) : output->desiredMode;
+        vector<xcb_randr_output_t> rrOutputs;
+        rrOutputs.reserve(group.size());
+        for (const auto &member : group)
+            rrOutputs.push_back((xcb_randr_output_t) member->rrOutput);
+
+        // a CRTC keeps its transform, so it is always set, taking effect with the mode
+        const bool scaled = output->desiredScaleFrom.first && output->desiredScaleFrom.second;
+        const char *filter = scaled ? "bilinear" : "nearest";
+        transformCookies.emplace_back(output, traffic.sent(
+                xcb_randr_set_crtc_transform_checked(conn, (xcb_randr_crtc_t) output->desiredCrtc,
+                                                     scaleTransform(output, mode), (uint16_t) strlen(filter), filter,
+                                                     0, nullptr)));
+        crtcCookies.emplace_back(output, traffic.sent(
+                xcb_randr_set_crtc_config(conn, (xcb_randr_crtc_t) output->desiredCrtc, XCB_CURRENT_TIME,
+                                          configTimestamp, (int16_t) output->desiredPos->x,
+                                          (int16_t) output->desiredPos->y, (xcb_randr_mode_t) mode->rrMode,
+                                          XCB_RANDR_ROTATION_ROTATE_0, (uint32_t) rrOutputs.size(),
+                                          rrOutputs.data())));
+    }
+
+    // primary
+    if (setPrimary)
+        primaryCookie = traffic.sent(
+                xcb_randr_set_output_primary_checked(conn, root, (xcb_randr_output_t) primary->rrOutput));
+
+    traffic.sent(xcb_ungrab_server(conn));
+
+    // wait for everything, remembering the first failure
+    string failure;
+    for (const auto &transformCookie : transformCookies) {
+        xcb_generic_error_t *error = xcb_request_check(conn, traffic.awaiting(transformCookie.second));
+        if (error) {
+            if (failure.empty())
+                failure = "unable to scale output " + transformCookie.first->name;
+            free(error);
+        }
+    }
+    for (const auto &crtcCookie : crtcCookies) {
+        const XcbReply<xcb_randr_set_crtc_config_reply_t> reply(
+                xcb_randr_set_crtc_config_reply(conn, traffic.awaiting(crtcCookie.second), nullptr), free);
+        if (failure.empty() && (!reply || reply->status != XCB_RANDR_SET_CONFIG_SUCCESS))
+            failure = "unable to configure CRTC for output " + crtcCookie.first->name;
+    }
+    xcb_generic_error_t *error = resize ? xcb_request_check(conn, traffic.awaiting(screenSizeCookie)) : nullptr;
+    if (error) {
+        if (failure.empty())
+            failure = "unable to set screen size " + to_string(width) + "x" + to_string(height);
+        free(error);
+    }
+    error = setPrimary ? xcb_request_check(conn, traffic.awaiting(primaryCookie)) : nullptr;
+    if (error) {
+        if (failure.empty())
+            failure = "unable to set primary output " + primary->name;
+        free(error);
+    }
+
+    if (!failure.empty())
+        throw runtime_error(failure);
+}
@@ -0,0 +1,39 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_APPLY_H
+#define XLAYOUTDISPLAY_APPLY_H
+
+#include "Output.h"
+#include "Session.h"
+
+#include <list>
+#include <memory>
+
+// apply the desired state of outputs directly via RandR, atomically within a server grab
+// outputs must have had their CRTCs assigned via assignCrtcs; only outputs that change are touched, and the screen is
+// resized only when its size or physical size changes
+// rate overrides the desired refresh when nonzero, as per xrandr --rate
+// the screen's physical size is set from dpi, as per xrandr --dpi
+// outputs with a desired scale are scaled from that area of the screen, as per xrandr --scale-from
+// throws invalid_argument:
+//   no desired active outputs
+// throws runtime_error:
+//   screen too large
+//   RandR requests fail
+void applyOutputs(const std::shared_ptr<Session> &session, const std::list<std::shared_ptr<Output>> &outputs,
+                  const std::shared_ptr<Output> &primary, const long &dpi, const long &rate);
+
+#endif //XLAYOUTDISPLAY_APPLY_H
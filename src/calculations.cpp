@@ -15,35 +15,49 @@
 */
 #include "calculations.h"
 #include "util.h"
+#include "Arena.h"
 
+#include <iomanip>
 #include <sstream>
 #include <cstring>
-#include <stack>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
 #include <system_error>
+#include <tuple>
 
 using namespace std;
 
-const std::list<std::shared_ptr<Output>> orderOutputs(const list<shared_ptr<Output>> &outputs, const vector<string> &order) {
-    list<shared_ptr<Output>> orderedOutputs(outputs);
+void orderOutputs(list<shared_ptr<Output>> &outputs, const OutputOrder &order) {
+    if (order.empty())
+        return;
 
-    // stack all the preferred, available outputs
-    stack<shared_ptr<Output>> preferredOutputs;
-    for (const auto &name : order) {
-        for (const auto &output : outputs) {
-            if (strcasecmp(name.c_str(), output->name.c_str()) == 0) {
-                preferredOutputs.push(output);
-            }
-        }
+    // fetch all EDID at once when needed
+    if (order.matchesEdid())
+        for (const auto &output : outputs)
+            output->edid.request();
+
+    // rank each once; only those matched need sorting, by rank then original position
+    typedef tuple<size_t, size_t, list<shared_ptr<Output>>::iterator> Match;
+    vector<Match> matched;
+    matched.reserve(outputs.size());
+    size_t position = 0;
+    for (auto output = outputs.begin(); output != outputs.end(); output++, position++) {
+        const size_t rank = order.rank(**output);
+        if (rank < order.size())
+            matched.emplace_back(rank, position, output);
     }
+    sort(matched.begin(), matched.end(), [](const Match &l, const Match &r) {
+        return get<0>(l) < get<0>(r) || (get<0>(l) == get<0>(r) && get<1>(l) < get<1>(r));
+    });
 
-    // move preferred to the front
-    while (!preferredOutputs.empty()) {
-        orderedOutputs.remove(preferredOutputs.top());
-        orderedOutputs.push_front(preferredOutputs.top());
-        preferredOutputs.pop();
-    }
+    // move them to the front, last first
+    for (auto match = matched.rbegin(); match != matched.rend(); match++)
+        outputs.splice(outputs.begin(), outputs, get<2>(*match));
+}
 
-    return orderedOutputs;
+void orderOutputs(list<shared_ptr<Output>> &outputs, const vector<string> &order) {
+    orderOutputs(outputs, OutputOrder(order));
 }
 
 const shared_ptr<Output> activateOutputs(const list<shared_ptr<Output>> &outputs, const string &desiredPrimary,
@@ -80,6 +94,7 @@ const shared_ptr<Output> activateOutputs(const list<shared_ptr<Output>> &outputs
 }
 
 void ltrOutputs(const list<shared_ptr<Output>> &outputs) {
+    Arena<Pos> positions(outputs.size());
     int xpos = 0;
     int ypos = 0;
     for (const auto &output : outputs) {
@@ -90,7 +105,7 @@ void ltrOutputs(const list<shared_ptr<Output>> &outputs) {
             output->desiredMode = output->optimalMode;
 
             // position the screen
-            output->desiredPos = make_shared<Pos>(xpos, ypos);
+            output->desiredPos = positions.make(xpos, ypos);
 
             // next position
             xpos += output->desiredMode->width;
@@ -100,7 +115,7 @@ void ltrOutputs(const list<shared_ptr<Output>> &outputs) {
 
 void mirrorOutputs(const list<shared_ptr<Output>> &outputs) {
 
-    // find the first active output
+    // resolutions are tried in descending order, from the first active output
     shared_ptr<Output> firstOutput;
     for (const auto &output : outputs) {
         if (output->desiredActive) {
@@ -111,46 +126,64 @@ void mirrorOutputs(const list<shared_ptr<Output>> &outputs) {
     if (!firstOutput)
         return;
 
-    // iterate through first active output's modes
-    for (const auto &possibleMode : reverseSort(firstOutput->modes)) {
-        bool matched = true;
-
-        // attempt to match mode to each active output
-        for (const auto &output : outputs) {
-            if (!output->desiredActive)
-                continue;
-
-            // reset failed matches
-            shared_ptr<const Mode> desiredMode;
-
-            // match height and width
-            for (const auto &mode : reverseSort(output->modes)) {
-                if (mode->width == possibleMode->width && mode->height == possibleMode->height) {
-
-                    // select best refresh
-                    desiredMode = mode;
-                    break;
-                }
+    // the highest that all others share
+    const ModeTable &modes = firstOutput->modes;
+    for (auto it = modes.begin(); it != modes.end(); it = modes.nextResolution(it)) {
+        const unsigned int width = (*it)->width;
+        const unsigned int height = (*it)->height;
+        bool shared = true;
+        for (const auto &output : outputs)
+            if (output->desiredActive && !output->modes.best(width, height)) {
+                shared = false;
+                break;
             }
+        if (!shared)
+            continue;
 
-            // match a mode for every output; root it at 0, 0
-            matched = matched && desiredMode;
-            if (matched) {
-                output->desiredMode = desiredMode;
-                output->desiredPos = make_shared<Pos>(0, 0);
-                continue;
+        // best refresh at that resolution for each; root all at the one 0, 0
+        const shared_ptr<const Pos> origin = make_shared<Pos>(0, 0);
+        for (const auto &output : outputs) {
+            if (output->desiredActive) {
+                output->desiredMode = output->modes.best(width, height);
+                output->desiredPos = origin;
             }
         }
-
-        // we've set desiredMode and desiredPos (zero) for all outputs, all done
-        if (matched)
-            return;
+        return;
     }
 
     // couldn't find a common mode, exit
     throw runtime_error("unable to find common width/height for mirror");
 }
 
+void scaleMirrorOutputs(const list<shared_ptr<Output>> &outputs, const shared_ptr<Output> &primary,
+                        const bool &largest) {
+    if (!primary) throw invalid_argument("scaleMirrorOutputs received empty primary");
+
+    // the screen that all show
+    shared_ptr<const Mode> screen = primary->optimalMode;
+    if (largest) {
+        for (const auto &output : outputs) {
+            const shared_ptr<const Mode> &mode = output->optimalMode;
+            if (output->desiredActive && mode &&
+                (!screen || mode->width * mode->height > screen->width * screen->height))
+                screen = mode;
+        }
+    }
+    if (!screen)
+        return;
+
+    // native modes, scaled when they differ; root all at the one 0, 0
+    const shared_ptr<const Pos> origin = make_shared<Pos>(0, 0);
+    for (const auto &output : outputs) {
+        if (!output->desiredActive || !output->optimalMode)
+            continue;
+        output->desiredMode = output->optimalMode;
+        output->desiredPos = origin;
+        if (output->desiredMode->width != screen->width || output->desiredMode->height != screen->height)
+            output->desiredScaleFrom = make_pair(screen->width, screen->height);
+    }
+}
+
 const string renderUserInfo(const list<shared_ptr<Output>> &outputs) {
     stringstream ss;
     for (const auto &output : outputs) {
@@ -168,11 +201,15 @@ const string renderUserInfo(const list<shared_ptr<Output>> &outputs) {
         }
         if (output->edid) {
             ss << ' ' << output->edid->maxCmHoriz() << "cm/" << output->edid->maxCmVert() << "cm";
+            ss << ' ' << OUTPUT_ORDER_EDID_PREFIX << hex << setfill('0') << setw(16) << output->edid->fingerprint()
+               << dec << setfill(' ');
         }
         if (output->currentMode && output->currentPos) {
             ss << ' ' << output->currentMode->width << 'x' << output->currentMode->height;
             ss << '+' << output->currentPos->x << '+' << output->currentPos->y;
             ss << ' ' << output->currentMode->refresh << "Hz";
+            if (output->currentScaleFrom.first && output->currentScaleFrom.second)
+                ss << " scaled from " << output->currentScaleFrom.first << 'x' << output->currentScaleFrom.second;
         }
         ss << endl;
         for (const auto &mode : output->modes) {
@@ -223,24 +260,256 @@ long calculateDpi(const shared_ptr<Output> &output, string *explaination) {
     return dpi;
 }
 
-const shared_ptr<const Mode> calculateOptimalMode(const list<shared_ptr<const Mode>> &modes, const shared_ptr<const Mode> &preferredMode) {
-    shared_ptr<const Mode> optimalMode;
+const shared_ptr<const Mode> calculateOptimalMode(const ModeTable &modes, const shared_ptr<const Mode> &preferredMode) {
 
     // default optimal mode is empty
-    if (!modes.empty()) {
+    if (modes.empty())
+        return nullptr;
+
+    // override with highest refresh of preferred resolution, if available
+    if (preferredMode) {
+        const shared_ptr<const Mode> &preferred = modes.best(preferredMode->width, preferredMode->height);
+        if (preferred)
+            return preferred;
+    }
+
+    // use highest resolution/refresh for optimal
+    return modes.front();
+}
+
+// a CRTC and the output given it; shared when clones of the owner already show it, so that it is never taken
+struct CrtcOwner {
+    RRCrtc crtc;
+    Output *output;
+    bool shared;
+};
+
+// owners sorted by CRTC, with room for one per active output so that claiming never allocates
+typedef vector<CrtcOwner> CrtcOwners;
+
+static CrtcOwners::iterator findOwner(CrtcOwners &owners, const RRCrtc &crtc) {
+    const auto it = lower_bound(owners.begin(), owners.end(), crtc, [](const CrtcOwner &owner, const RRCrtc &id) {
+        return owner.crtc < id;
+    });
+    return it != owners.end() && it->crtc == crtc ? it : owners.end();
+}
+
+// give crtc to output, replacing any previous owner
+static void claim(CrtcOwners &owners, const RRCrtc &crtc, Output *output) {
+    const auto it = lower_bound(owners.begin(), owners.end(), crtc, [](const CrtcOwner &owner, const RRCrtc &id) {
+        return owner.crtc < id;
+    });
+    if (it != owners.end() && it->crtc == crtc)
+        it->output = output;
+    else
+        owners.insert(it, {crtc, output, false});
+    output->desiredCrtc = crtc;
+}
+
+// give output a CRTC that is free or that may be taken from its owner, who is in turn given another
+// owners that keep their current CRTC are not disturbed unless moveKept, nor are shared CRTCs; visited CRTCs are not
+// taken again
+static bool augment(Output *output, CrtcOwners &owners, vector<RRCrtc> &visited, const bool &moveKept) {
+    for (const auto &crtc : output->crtcs) {
+        if (findOwner(owners, crtc) == owners.end()) {
+            claim(owners, crtc, output);
+            return true;
+        }
+    }
+    for (const auto &crtc : output->crtcs) {
+        if (find(visited.begin(), visited.end(), crtc) != visited.end())
+            continue;
+        visited.push_back(crtc);
+        const CrtcOwner &owner = *findOwner(owners, crtc);
+        if (owner.output == output || owner.shared ||
+            (!moveKept && owner.output->desiredCrtc == owner.output->crtc))
+            continue;
+        if (augment(owner.output, owners, visited, moveKept)) {
+            claim(owners, crtc, output);
+            return true;
+        }
+    }
+    return false;
+}
+
+// true if a and b list each other as clones and will show the same mode at the same position
+static bool cloneable(const Output &a, const Output &b) {
+    return find(a.clones.begin(), a.clones.end(), b.rrOutput) != a.clones.end() &&
+           find(b.clones.begin(), b.clones.end(), a.rrOutput) != b.clones.end() &&
+           a.desiredMode && b.desiredMode && a.desiredMode->rrMode == b.desiredMode->rrMode &&
+           a.desiredPos && b.desiredPos && a.desiredPos->x == b.desiredPos->x && a.desiredPos->y == b.desiredPos->y &&
+           a.desiredScaleFrom == b.desiredScaleFrom;
+}
+
+// true if output may join the outputs already given crtc
+static bool shareable(const Output &output, const vector<Output *> &active, const RRCrtc &crtc) {
+    for (const auto &other : active)
+        if (other != &output && other->desiredCrtc == crtc && !cloneable(output, *other))
+            return false;
+    return true;
+}
+
+void assignCrtcs(const list<shared_ptr<Output>> &outputs) {
+    vector<Output *> active;
+    active.reserve(outputs.size());
+    size_t ncrtc = 0;
+    for (const auto &output : outputs) {
+        output->desiredCrtc = 0;
+        if (output->desiredActive) {
+            active.push_back(output.get());
+            ncrtc += output->crtcs.size();
+        }
+    }
+
+    // keep CRTCs of outputs that remain active, along with clones that already share them
+    CrtcOwners owners;
+    owners.reserve(active.size());
+    for (const auto &output : active) {
+        if (!output->crtc)
+            continue;
+        const auto owner = findOwner(owners, output->crtc);
+        if (owner == owners.end()) {
+            claim(owners, output->crtc, output);
+        } else if (shareable(*output, active, output->crtc)) {
+            output->desiredCrtc = output->crtc;
+            owner->shared = true;
+        }
+    }
+
+    // match the rest, first around those kept, then moving them when there is no other way
+    vector<RRCrtc> visited;
+    visited.reserve(ncrtc);
+    for (const bool moveKept : {false, true}) {
+        for (const auto &output : active) {
+            if (!output->desiredCrtc) {
+                visited.clear();
+                augment(output, owners, visited, moveKept);
+            }
+        }
+    }
+
+    // share with clones
+    for (const auto &output : active) {
+        if (output->desiredCrtc)
+            continue;
+        for (const auto &crtc : output->crtcs) {
+            if (shareable(*output, active, crtc)) {
+                output->desiredCrtc = crtc;
+                break;
+            }
+        }
+        if (!output->desiredCrtc)
+            throw runtime_error("no free CRTC available for output " + output->name);
+    }
+}
+
+const vector<vector<shared_ptr<Output>>> crtcGroups(const list<shared_ptr<Output>> &outputs) {
+    vector<vector<shared_ptr<Output>>> groups;
+    for (const auto &output : outputs) {
+        if (!output->desiredActive || !output->desiredCrtc)
+            continue;
+        const auto group = find_if(groups.begin(), groups.end(), [&output](const vector<shared_ptr<Output>> &g) {
+            return g.front()->desiredCrtc == output->desiredCrtc;
+        });
+        if (group == groups.end())
+            groups.push_back({output});
+        else
+            group->push_back(output);
+    }
+    return groups;
+}
+
+const pair<unsigned int, unsigned int> calculateScreenSize(const list<shared_ptr<Output>> &outputs) {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    for (const auto &output : outputs) {
+        if (output->desiredActive && output->desiredMode && output->desiredPos) {
+            const pair<unsigned int, unsigned int> area = output->desiredArea();
+            width = max(width, output->desiredPos->x + area.first);
+            height = max(height, output->desiredPos->y + area.second);
+        }
+    }
+    return make_pair(width, height);
+}
+
+const pair<unsigned int, unsigned int> calculateScreenMm(const pair<unsigned int, unsigned int> &size,
+                                                        const long &dpi) {
+    // truncated, in the same order of operations as xrandr
+    return make_pair((unsigned int) ((MM_PER_INCH * size.first) / (double) dpi),
+                     (unsigned int) ((MM_PER_INCH * size.second) / (double) dpi));
+}
 
-        // use highest resolution/refresh for optimal
-        const list<shared_ptr<const Mode>> reverseOrderedModes = reverseSort(modes);
-        optimalMode = reverseOrderedModes.front();
+bool screenMmDiffers(const pair<unsigned int, unsigned int> &a, const pair<unsigned int, unsigned int> &b) {
+    return labs((long) a.first - (long) b.first) > 1 || labs((long) a.second - (long) b.second) > 1;
+}
 
-        // override with highest refresh of preferred resolution, if available
-        if (preferredMode)
-            for (const auto &mode : reverseOrderedModes)
-                if (mode->width == preferredMode->width && mode->height == preferredMode->height) {
-                    optimalMode = mode;
-                    break;
-                }
+const shared_ptr<const Mode> calculateRateMode(const shared_ptr<Output> &output, const long &rate) {
+    if (!output->desiredMode) throw invalid_argument("calculateRateMode received output without desiredMode");
+
+    shared_ptr<const Mode> rateMode = output->desiredMode;
+    long distance = labs(rate - (long) rateMode->refresh);
+    for (const auto &mode : output->modes) {
+        if (mode->width == rateMode->width && mode->height == rateMode->height &&
+            labs(rate - (long) mode->refresh) < distance) {
+            rateMode = mode;
+            distance = labs(rate - (long) mode->refresh);
+        }
     }
+    return rateMode;
+}
+
+Output::Change calculateChange(const shared_ptr<Output> &output, const long &rate) {
+    const bool current = output->crtc && output->currentMode && output->currentPos;
+    const bool desired = output->desiredActive && output->desiredMode && output->desiredPos;
+
+    if (!desired)
+        return current ? Output::disable : Output::unchanged;
+    if (!current)
+        return Output::modeset;
+
+    const shared_ptr<const Mode> desiredMode = rate ? calculateRateMode(output, rate) : output->desiredMode;
+    if (output->currentMode->rrMode != desiredMode->rrMode ||
+        output->currentArea() != output->desiredArea() ||
+        (output->desiredCrtc && output->desiredCrtc != output->crtc))
+        return Output::modeset;
+
+    if (output->currentPos->x != output->desiredPos->x || output->currentPos->y != output->desiredPos->y)
+        return Output::reposition;
+
+    return Output::unchanged;
+}
 
-    return optimalMode;
+Changes::Changes(const list<shared_ptr<Output>> &outputs, const shared_ptr<Output> &primary, const long &rate,
+                 const bool &dpi) : dpi(dpi) {
+    for (const auto &output : outputs) {
+        switch (calculateChange(output, rate)) {
+            case Output::modeset:
+                modesets++;
+                break;
+            case Output::reposition:
+                repositions++;
+                break;
+            case Output::disable:
+                disables++;
+                break;
+            default:
+                break;
+        }
+    }
+    this->primary = primary && !primary->currentPrimary;
+}
+
+const string renderChanges(const Changes &changes) {
+    if (changes.none())
+        return "no changes";
+
+    stringstream ss;
+    ss << changes.modesets << (changes.modesets == 1 ? " modeset" : " modesets");
+    ss << ", " << changes.repositions << (changes.repositions == 1 ? " reposition" : " repositions");
+    ss << ", " << changes.disables << (changes.disables == 1 ? " disable" : " disables");
+    if (changes.primary)
+        ss << ", primary change";
+    if (changes.dpi)
+        ss << ", DPI change";
+    return ss.str();
 }
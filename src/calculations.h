@@ -17,12 +17,21 @@
 #define XLAYOUTDISPLAY_CALCULATIONS_H
 
 #include <vector>
+#include <utility>
 #include "Output.h"
+#include "OutputOrder.h"
 
 #define DEFAULT_DPI 96
+#define MM_PER_INCH 25.4
 
-// reorder outputs putting those whose names match order at the front, case insensitive
-const std::list<std::shared_ptr<Output>> orderOutputs(const std::list<std::shared_ptr<Output>> &outputs, const std::vector<std::string> &order);
+// reorder outputs in place, putting those that match order at the front, in the order of the first entry each matches
+// the list's nodes are moved rather than copied, so that the allocations made do not grow with the number of outputs
+void orderOutputs(std::list<std::shared_ptr<Output>> &outputs, const OutputOrder &order);
+
+// compiles order on each call
+// throws invalid_argument:
+//   invalid order entry
+void orderOutputs(std::list<std::shared_ptr<Output>> &outputs, const std::vector<std::string> &order);
 
 // mark outputs that should be activated and return the nonempty primary
 // throws invalid_argument:
@@ -33,11 +42,20 @@ const std::shared_ptr<Output> activateOutputs(const std::list<std::shared_ptr<Ou
 // arrange outputs left to right at optimal mode; will mutate contents
 void ltrOutputs(const std::list<std::shared_ptr<Output>> &outputs);
 
-// arrange outputs so that they all mirror at highest common mode; will mutate contents
+// arrange outputs so that they all mirror at highest common width then height, each at its highest refresh for that
+// resolution; will mutate contents
 // throws runtime_error:
 //   no common mode found
 void mirrorOutputs(const std::list<std::shared_ptr<Output>> &outputs);
 
+// arrange outputs so that they all mirror one screen, each at its optimal mode scaled from the screen when the sizes
+// differ; the screen takes the size of primary's optimal mode, or that of the largest optimal mode when largest is set
+// aspect ratios are not preserved; will mutate contents
+// throws invalid_argument:
+//   when primary is empty
+void scaleMirrorOutputs(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary,
+                        const bool &largest);
+
 // render a user readable string explaining the current state of outputs
 const std::string renderUserInfo(const std::list<std::shared_ptr<Output>> &outputs);
 
@@ -48,8 +66,62 @@ const std::string renderUserInfo(const std::list<std::shared_ptr<Output>> &outpu
 //   when output is empty
 long calculateDpi(const std::shared_ptr<Output> &output, std::string *explaination);
 
-// retrieve the highest resolution/refresh mode from a list of modes, using the highest refresh rate of preferredMode, if available
-const std::shared_ptr<const Mode> calculateOptimalMode(const std::list<std::shared_ptr<const Mode>> &modes,
+// retrieve the highest resolution/refresh mode from a table of modes, using the highest refresh rate of preferredMode, if available
+const std::shared_ptr<const Mode> calculateOptimalMode(const ModeTable &modes,
                                                        const std::shared_ptr<const Mode> &preferredMode);
 
+// set desiredCrtc for desired active outputs, using only CRTCs each may use
+// outputs keep their current CRTC when possible, as do clones already sharing one; the rest are matched to the others,
+// moving outputs between CRTCs only when there is no other way
+// an output left without a CRTC may share one with outputs that it clones, all showing the same mode at the same
+// position
+// throws runtime_error:
+//   no valid assignment
+void assignCrtcs(const std::list<std::shared_ptr<Output>> &outputs);
+
+// desired active outputs that have been assigned CRTCs, grouped by CRTC in order of each group's first output
+// a group has more than one output only when they are clones
+const std::vector<std::vector<std::shared_ptr<Output>>> crtcGroups(const std::list<std::shared_ptr<Output>> &outputs);
+
+// smallest width and height that contains all desired active outputs, as scaled
+const std::pair<unsigned int, unsigned int> calculateScreenSize(const std::list<std::shared_ptr<Output>> &outputs);
+
+// physical width and height in millimetres of a screen of size at dpi, as per xrandr --dpi
+const std::pair<unsigned int, unsigned int> calculateScreenMm(const std::pair<unsigned int, unsigned int> &size,
+                                                              const long &dpi);
+
+// true if physical sizes a and b differ by more than the millimetre that X servers, which round, and xrandr --dpi,
+// which truncates, may disagree by
+bool screenMmDiffers(const std::pair<unsigned int, unsigned int> &a, const std::pair<unsigned int, unsigned int> &b);
+
+// the output's mode with the resolution of desiredMode and the closest refresh to rate, as per xrandr --rate
+// throws invalid_argument:
+//   when output has no desiredMode
+const std::shared_ptr<const Mode> calculateRateMode(const std::shared_ptr<Output> &output, const long &rate);
+
+// compare current and desired state; modes are compared by RRMode, along with any scaling
+// rate overrides the desired refresh when nonzero
+Output::Change calculateChange(const std::shared_ptr<Output> &output, const long &rate);
+
+// number of outputs needing each change, and whether the primary changes
+class Changes {
+public:
+    // rate overrides the desired refresh when nonzero
+    // dpi is set when the screen's physical size is to change, which may happen without any output changing
+    Changes(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary,
+            const long &rate, const bool &dpi);
+
+    // nothing at all to do
+    bool none() const { return !modesets && !repositions && !disables && !primary && !dpi; }
+
+    unsigned int modesets = 0;
+    unsigned int repositions = 0;
+    unsigned int disables = 0;
+    bool primary = false;
+    bool dpi = false;
+};
+
+// render a user readable string describing changes
+const std::string renderChanges(const Changes &changes);
+
 #endif //XLAYOUTDISPLAY_CALCULATIONS_H
@@ -0,0 +1,140 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "daemon.h"
+
+#include "layout.h"
+#include "Session.h"
+#include "Settler.h"
+#include "Timings.h"
+#include "XBackend.h"
+#include "xrandrrutil.h"
+
+#include <X11/extensions/Xrandr.h>
+#include <poll.h>
+
+#include <cerrno>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <set>
+#include <system_error>
+
+using namespace std;
+
+// discover outputs then lay them out, returning the range of request serials used, [first, last)
+// outputs are rediscovered when present, querying only those changed, otherwise discovered from nothing
+// outputs are cleared on failure, as their state is no longer known
+static pair<unsigned long, unsigned long> layoutOnce(const Settings &settings, XBackend &backend,
+                                                     list<shared_ptr<Output>> &outputs, const set<RROutput> &changed) {
+    Display *dpy = backend.session->dpy;
+    const unsigned long first = NextRequest(dpy);
+    try {
+        Timings timings(settings.timings);
+        timings.countTraffic([&backend]() { return backend.traffic(); });
+        Timings::Phase phase = timings.phase("discover");
+        string discoveryExplaination;
+        if (outputs.empty()) {
+            outputs = backend.discover(settings.probe, &discoveryExplaination);
+        } else {
+            outputs = backend.rediscover(outputs, changed, &discoveryExplaination);
+        }
+        phase.stop();
+        const int rc = layout(settings, backend, outputs, discoveryExplaination, timings);
+        printTimings(timings);
+        if (rc != 0) {
+            cerr << "layout failed with exit status " << rc << "\n";
+            outputs.clear();
+        }
+    } catch (const exception &e) {
+        cerr << "layout failed: " << e.what() << "\n";
+        outputs.clear();
+    }
+
+    // all our requests have been processed once the sync returns, so their events are queued
+    XSync(dpy, False);
+    return make_pair(first, NextRequest(dpy));
+}
+
+int runDaemon(const Settings &settings) {
+
+    // an unknown timings format is reported now rather than by every layout
+    Timings(settings.timings);
+
+    // one connection for the lifetime of the daemon
+    XBackend backend(make_shared<Session>(settings.displays.empty() ? nullptr : settings.displays.front().c_str()));
+    Display *dpy = backend.session->dpy;
+
+    int eventBase, errorBase;
+    if (!XRRQueryExtension(dpy, &eventBase, &errorBase))
+        throw runtime_error("RandR extension not available");
+    XRRSelectInput(dpy, backend.session->root,
+                   RRScreenChangeNotifyMask | RROutputChangeNotifyMask | RRCrtcChangeNotifyMask);
+
+    Settler settler{chrono::milliseconds(settings.settle)};
+    pollfd pfd{ConnectionNumber(dpy), POLLIN, 0};
+
+    // the previous outputs and what has changed since they were discovered
+    list<shared_ptr<Output>> outputs;
+    set<RROutput> changedOutputIds;
+    set<RRCrtc> changedCrtcIds;
+
+    const pair<unsigned long, unsigned long> own = layoutOnce(settings, backend, outputs, {});
+    settler.own(own.first, own.second);
+    for (;;) {
+
+        // drain everything queued; nothing is retained beyond the changed ids
+        while (XPending(dpy)) {
+            XEvent event;
+            XNextEvent(dpy, &event);
+            if (event.type != eventBase + RRScreenChangeNotify && event.type != eventBase + RRNotify)
+                continue;
+            XRRUpdateConfiguration(&event);
+
+            if (event.type == eventBase + RRNotify) {
+                const auto *notify = reinterpret_cast<const XRRNotifyEvent *>(&event);
+                if (notify->subtype == RRNotify_OutputChange)
+                    changedOutputIds.insert(reinterpret_cast<const XRROutputChangeNotifyEvent *>(&event)->output);
+                else if (notify->subtype == RRNotify_CrtcChange)
+                    changedCrtcIds.insert(reinterpret_cast<const XRRCrtcChangeNotifyEvent *>(&event)->crtc);
+            }
+
+            // our own changes are rediscovered next time, without causing a layout
+            settler.event(chrono::steady_clock::now(), event.xany.serial);
+        }
+
+        // Xlib does not exit when the server goes away
+        if (xcb_connection_has_error(backend.session->conn))
+            throw runtime_error("lost connection to X");
+
+        // lay out once settled
+        const int timeout = settler.timeout(chrono::steady_clock::now());
+        if (timeout == 0) {
+            if (!settings.quiet)
+                cout << "\nlaying out after " << settler.pending() << " RandR events\n";
+            settler.settled();
+            const set<RROutput> changed = changedOutputs(outputs, changedOutputIds, changedCrtcIds);
+            changedOutputIds.clear();
+            changedCrtcIds.clear();
+            const pair<unsigned long, unsigned long> own = layoutOnce(settings, backend, outputs, changed);
+            settler.own(own.first, own.second);
+            continue;
+        }
+
+        // wait for more events or the remainder of the settle period
+        if (poll(&pfd, 1, timeout) < 0 && errno != EINTR)
+            throw system_error(errno, generic_category(), "unable to wait for X events");
+    }
+}
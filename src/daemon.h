@@ -0,0 +1,35 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_DAEMON_H
+#define XLAYOUTDISPLAY_DAEMON_H
+
+#include "Settings.h"
+
+// lay out outputs, then stay resident and lay out again whenever RandR reports a screen, output or CRTC change
+// bursts of events are collapsed into one layout, performed once no event has arrived for settings.settle ms
+// only outputs reported as changed are rediscovered; events caused by our own layout mark outputs as changed but do
+// not cause a layout
+// a failed layout is reported and the daemon continues; returns only on error
+// throws invalid_argument:
+//   unknown timings format
+// throws runtime_error:
+//   RandR not available
+//   lost connection to X
+// throws system_error:
+//   unable to wait for events
+int runDaemon(const Settings &settings);
+
+#endif //XLAYOUTDISPLAY_DAEMON_H
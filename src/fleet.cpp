@@ -0,0 +1,141 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "fleet.h"
+
+#include "layout.h"
+
+#include <X11/Xlib.h>
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+vector<string> localDisplays(const char *socketDir) {
+    vector<pair<unsigned long, string>> numbered;
+    DIR *dir = opendir(socketDir);
+    if (dir) {
+        struct dirent *dirent;
+        while ((dirent = readdir(dir)) != nullptr) {
+            const char *name = dirent->d_name;
+            if (name[0] != 'X' || !name[1] || strspn(name + 1, "0123456789") != strlen(name + 1))
+                continue;
+            numbered.emplace_back(strtoul(name + 1, nullptr, 10), string(":") + (name + 1));
+        }
+        closedir(dir);
+    }
+    sort(numbered.begin(), numbered.end());
+
+    vector<string> displays;
+    for (const auto &display : numbered)
+        displays.push_back(display.second);
+    return displays;
+}
+
+// the job for the display reports its loss; Session keeps Xlib from exiting
+static int quietIOError(Display *) {
+    return 0;
+}
+
+static FleetResult layoutDisplay(const Settings &settings, const string &display) {
+    FleetResult result;
+    result.display = display;
+    stringstream feedback;
+    const auto start = chrono::steady_clock::now();
+    try {
+        result.rc = layout(settings, display, feedback, feedback);
+    } catch (const exception &e) {
+        result.rc = EXIT_FAILURE;
+        result.error = e.what();
+    }
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    result.ms = elapsed.count();
+    result.feedback = feedback.str();
+    return result;
+}
+
+vector<FleetResult> layoutFleet(const Settings &settings, const vector<string> &displays, const long &jobs) {
+    vector<FleetResult> results(displays.size());
+
+    // Xlib is used from many threads, albeit with a connection each
+    XInitThreads();
+    XSetIOErrorHandler(quietIOError);
+
+    // each worker takes the next display until none remain
+    const size_t nthread = min(jobs > 0 ? (size_t) jobs : FLEET_DEFAULT_JOBS, displays.size());
+    atomic<size_t> next(0);
+    const auto work = [&]() {
+        for (size_t i = next++; i < displays.size(); i = next++)
+            results[i] = layoutDisplay(settings, displays[i]);
+    };
+    vector<thread> workers;
+    for (size_t i = 1; i < nthread; i++)
+        workers.emplace_back(work);
+    work();
+    for (auto &worker : workers)
+        worker.join();
+
+    return results;
+}
+
+int runFleet(const Settings &settings) {
+    const vector<string> displays = settings.displays.empty() ? localDisplays(X11_SOCKET_DIR) : settings.displays;
+    if (displays.empty())
+        throw runtime_error("no displays found in " X11_SOCKET_DIR);
+
+    const auto start = chrono::steady_clock::now();
+    const vector<FleetResult> results = layoutFleet(settings, displays, settings.jobs);
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+    // what each would have printed, in display order; only timings when quiet
+    size_t failed = 0;
+    for (const auto &result : results) {
+        if (result.rc != EXIT_SUCCESS)
+            failed++;
+        if ((!settings.quiet || !settings.timings.empty()) && !result.feedback.empty())
+            cout << "==> " << result.display << " <==\n" << result.feedback << "\n";
+    }
+
+    // outcomes, failures regardless of quiet
+    for (const auto &result : results) {
+        stringstream outcome;
+        outcome << result.display << ' ';
+        if (result.rc == EXIT_SUCCESS)
+            outcome << "laid out";
+        else if (!result.error.empty())
+            outcome << "failed: " << result.error << ',';
+        else
+            outcome << "failed with exit status " << result.rc << ',';
+        outcome << " in " << fixed << setprecision(1) << result.ms << "ms\n";
+        if (result.rc != EXIT_SUCCESS)
+            cerr << outcome.str();
+        else if (!settings.quiet)
+            cout << outcome.str();
+    }
+    if (!settings.quiet)
+        cout << results.size() << " displays in " << fixed << setprecision(1) << elapsed.count() << "ms, "
+             << failed << " failed\n";
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_FLEET_H
+#define XLAYOUTDISPLAY_FLEET_H
+
+#include "Settings.h"
+
+#include <string>
+#include <vector>
+
+#define X11_SOCKET_DIR "/tmp/.X11-unix"
+
+// layouts mostly wait on their X server, so many more than the hardware threads may run at once
+#define FLEET_DEFAULT_JOBS 16
+
+// names of the local X displays with a socket in socketDir, X0 as :0, by display number; empty when none
+std::vector<std::string> localDisplays(const char *socketDir);
+
+// the outcome of laying out one display
+struct FleetResult {
+    std::string display;
+    int rc = 0;
+    // exception message when laying out failed
+    std::string error;
+    // everything the layout would have printed
+    std::string feedback;
+    double ms = 0;
+};
+
+// lay out each display concurrently, on at most jobs threads, each with its own connection
+// jobs defaults to FLEET_DEFAULT_JOBS when not positive
+// a display that cannot be opened or whose connection is lost fails on its own, without affecting the others
+std::vector<FleetResult> layoutFleet(const Settings &settings, const std::vector<std::string> &displays,
+                                     const long &jobs);
+
+// lay out settings.displays, or all local displays when none, using layoutFleet
+// feedback for each display is printed in order once all are done, followed by the outcome and time of each
+// returns EXIT_FAILURE when any failed
+// throws runtime_error:
+//   no displays found
+int runFleet(const Settings &settings);
+
+#endif //XLAYOUTDISPLAY_FLEET_H
@@ -15,35 +15,87 @@
 */
 #include "layout.h"
 
+#include "ProfileCache.h"
+#include "SnapshotBackend.h"
+#include "Timings.h"
+#include "XBackend.h"
 #include "xrandrrutil.h"
 #include "xrdbutil.h"
-#include "xutil.h"
 #include "calculations.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 
 using namespace std;
 
 int layout(const Settings &settings) {
+    if (settings.displays.size() > 1)
+        throw invalid_argument("more than one --display requires --fleet");
+    return layout(settings, settings.displays.empty() ? string() : settings.displays.front(), cout, cerr);
+}
 
-    // discover monitors
-    const Monitors monitors = Monitors();
+int layout(const Settings &settings, const string &display, ostream &out, ostream &err) {
+    Timings timings(settings.timings);
+
+    // a recorded snapshot, otherwise one connection to X for all stages, closed on return
+    Timings::Phase phase = timings.phase("connect");
+    unique_ptr<Backend> backend;
+    if (!settings.snapshot.empty()) {
+        ifstream snapshot(settings.snapshot);
+        if (!snapshot)
+            throw runtime_error("unable to read snapshot '" + settings.snapshot + "'");
+        backend.reset(new SnapshotBackend(snapshot));
+    } else {
+        backend.reset(new XBackend(make_shared<Session>(display.empty() ? nullptr : display.c_str())));
+    }
 
     // discover outputs
-    const list<shared_ptr<Output>> currentOutputs = discoverOutputs();
+    timings.countTraffic([&backend]() { return backend->traffic(); });
+    phase = timings.phase("discover");
+    string discoveryExplaination;
+    const list<shared_ptr<Output>> currentOutputs = backend->discover(settings.probe, &discoveryExplaination);
+    phase.stop();
+
+    const int rc = layout(settings, *backend, currentOutputs, discoveryExplaination, timings, out, err);
+    printTimings(timings, out);
+    return rc;
+}
+
+void printTimings(const Timings &timings, ostream &out) {
+    if (timings.format == Timings::text) {
+        out << "\n" << timings.render() << "\n";
+    } else if (timings.format == Timings::json) {
+        out << timings.render() << "\n";
+    }
+}
+
+int layout(const Settings &settings, Backend &backend,
+           const list<shared_ptr<Output>> &currentOutputs, const string &discoveryExplaination, Timings &timings,
+           ostream &out, ostream &err) {
+
+    // discover monitors
+    Timings::Phase phase = timings.phase("lid");
+    const Monitors monitors(backend.laptopLidClosed());
+    phase.stop();
+
     if (currentOutputs.empty()) {
         throw runtime_error("no outputs found");
     }
 
     // output verbose information
     if (!settings.quiet || settings.info) {
-        cout << renderUserInfo(currentOutputs) << "\n\n";
-        cout << "laptop lid ";
+        phase = timings.phase("info");
+        requestEdids(currentOutputs);
+        out << renderUserInfo(currentOutputs) << "\n\n";
+        out << "laptop lid ";
         if (monitors.laptopLidClosed) {
-            cout << "closed";
+            out << "closed";
         } else {
-            cout << "open or not present";
+            out << "open or not present";
         }
-        cout << "\n";
+        out << "\n\n" << discoveryExplaination << "\n";
+        phase.stop();
     }
 
     // current info is all output, we're done
@@ -51,62 +103,143 @@ int layout(const Settings &settings) {
         return EXIT_SUCCESS;
     }
 
-    // order the outputs if the user wishes
-    const list<shared_ptr<Output>> outputs = orderOutputs(currentOutputs, settings.order);
+    // a known combination of monitors and settings is laid out as before
+    phase = timings.phase("cache");
+    const ProfileCache profileCache(ProfileCache::defaultPath());
+    if (!settings.nocache) {
+        requestEdids(currentOutputs);
+    }
+    const uint64_t profile = settings.nocache ? 0 : ProfileCache::profileKey(currentOutputs);
+    const uint64_t profileSettings = ProfileCache::settingsKey(settings, monitors.laptopLidClosed);
+    list<shared_ptr<Output>> outputs = currentOutputs;
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    const bool cached = !settings.nocache &&
+                        profileCache.load(profile, profileSettings, currentOutputs, &primary, &dpi);
+    phase.stop();
+    if (cached) {
+        if (!settings.quiet) {
+            out << "\nusing cached layout with DPI " << to_string(dpi) << "\n";
+        }
+    } else {
+        phase = timings.phase("calculate");
 
-    // activate ouputs and determine primary
-    const shared_ptr<Output> primary = activateOutputs(outputs, settings.primary, monitors);
+        // order the outputs if the user wishes
+        orderOutputs(outputs, settings.outputOrder);
 
-    // arrange mirrored or left to right
-    if (settings.mirror) {
-        mirrorOutputs(outputs);
-    } else {
-        ltrOutputs(outputs);
-    }
+        // activate ouputs and determine primary
+        primary = activateOutputs(outputs, settings.primary, monitors);
 
-    // determine DPI from the primary
-    string dpiExplaination;
-    long dpi = calculateDpi(primary, &dpiExplaination);
-    if (!settings.quiet) {
-        cout << "\n" << dpiExplaination << "\n";
-    }
+        // arrange mirrored, scaled mirrored or left to right
+        if (!settings.scaledMirror.empty()) {
+            scaleMirrorOutputs(outputs, primary, settings.scaledMirror == "largest");
+        } else if (settings.mirror) {
+            mirrorOutputs(outputs);
+        } else {
+            ltrOutputs(outputs);
+        }
+
+        // determine DPI from the primary
+        string dpiExplaination;
+        dpi = calculateDpi(primary, &dpiExplaination);
+        if (!settings.quiet) {
+            out << "\n" << dpiExplaination << "\n";
+        }
 
-    // user overrides DPI
-    if (settings.dpi) {
-        dpi = settings.dpi;
-        cout << "overriding with provided DPI " << to_string(dpi) << "\n";
+        // user overrides DPI
+        if (settings.dpi) {
+            dpi = settings.dpi;
+            out << "overriding with provided DPI " << to_string(dpi) << "\n";
+        }
+        phase.stop();
     }
-    
+
     // user overrides refresh rate
     long rate = 0;
     if (settings.rate) {
         rate = settings.rate;
-        cout << "overriding with provided refresh rate " << to_string(rate) << "\n";
+        out << "overriding with provided refresh rate " << to_string(rate) << "\n";
+    }
+
+    // assign CRTCs and determine what will change
+    phase = timings.phase("plan");
+    assignCrtcs(outputs);
+
+    // physical size is set along with any resize, so it need only be compared for the current screen size
+    const bool dpiChange = screenMmDiffers(calculateScreenMm(backend.screenSize(), dpi), backend.screenMm());
+    const Changes changes(outputs, primary, rate, dpiChange);
+    if (!settings.quiet || settings.noop) {
+        out << "\n" << renderChanges(changes) << "\n";
     }
 
     // render desired commands
     const string xrandrCmd = renderXrandrCmd(outputs, primary, dpi, rate);
     const string xrdbCmd = renderXrdbCmd(dpi);
     if (!settings.quiet || settings.noop) {
-        cout << "\n" << xrandrCmd << "\n\n" << xrdbCmd << "\n";
+        out << "\n" << xrandrCmd << "\n\n" << xrdbCmd << "\n";
     }
+    phase.stop();
+
+    // a snapshot is replayed by its backend, never by commands that would act on the real X server
+    const bool xrandr = settings.xrandr && settings.snapshot.empty();
+    const bool xrdb = settings.xrdb && settings.snapshot.empty();
 
     // execute
     if (!settings.noop) {
-        // xrandr
-        int rc = system(xrandrCmd.c_str());
-        if (rc != 0) {
-            return rc;
+        bool reset = false;
+
+        // nothing to do when the outputs are already as desired
+        if (!changes.none()) {
+            phase = timings.phase(xrandr ? "xrandr" : "apply");
+            const auto start = chrono::steady_clock::now();
+            if (xrandr) {
+                // xrandr
+                int rc = system(xrandrCmd.c_str());
+                if (rc != 0) {
+                    return rc;
+                }
+            } else {
+                // RandR directly, or the snapshot
+                backend.apply(outputs, primary, dpi, rate);
+            }
+            const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            phase.stop();
+            if (!settings.quiet) {
+                out << "\napplied in " << fixed << setprecision(1) << elapsed.count() << "ms using "
+                     << (xrandr ? "xrandr" : settings.snapshot.empty() ? "RandR" : "snapshot") << "\n";
+            }
+            reset = true;
         }
 
-        // xrdb
-        rc = system(xrdbCmd.c_str());
-        if (rc != 0) {
-            return rc;
+        // Xft.dpi
+        phase = timings.phase(xrdb ? "xrdb" : "xftdpi");
+        if (xrdb) {
+            int rc = system(xrdbCmd.c_str());
+            if (rc != 0) {
+                return rc;
+            }
+            reset = true;
+        } else if (backend.applyXftDpi(dpi)) {
+            reset = true;
         }
+        phase.stop();
 
         // update root window's cursor
-        resetRootCursor();
+        if (reset) {
+            phase = timings.phase("cursor");
+            backend.resetRootCursor();
+            phase.stop();
+        }
+    }
+
+    // remember the layout for next time; failing to do so is not fatal
+    if (!cached && !settings.nocache && !settings.noop) {
+        phase = timings.phase("store");
+        try {
+            profileCache.store(profile, profileSettings, outputs, primary, dpi);
+        } catch (const exception &e) {
+            err << "unable to cache layout: " << e.what() << "\n";
+        }
     }
     return EXIT_SUCCESS;
 }
@@ -16,8 +16,36 @@
 #ifndef XLAYOUTDISPLAY_LAYOUT_H
 #define XLAYOUTDISPLAY_LAYOUT_H
 
+#include "Backend.h"
+#include "Output.h"
 #include "Settings.h"
+#include "Timings.h"
 
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+
+// discover, arrange and apply outputs once, using a new Session for the display in settings or the snapshot
+// timings are printed afterwards when requested
+// throws runtime_error:
+//   unable to read snapshot
+// throws invalid_argument:
+//   unknown timings format
+//   more than one display
 int layout(const Settings &settings);
 
+// as above, for display, the default when empty, writing feedback to out and failures to cache to err
+int layout(const Settings &settings, const std::string &display, std::ostream &out, std::ostream &err);
+
+// arrange and apply currentOutputs, discovered using backend
+// discoveryExplaination is reported along with the current outputs; each phase is added to timings
+// feedback is written to out and a failure to cache to err
+int layout(const Settings &settings, Backend &backend,
+           const std::list<std::shared_ptr<Output>> &currentOutputs, const std::string &discoveryExplaination,
+           Timings &timings, std::ostream &out = std::cout, std::ostream &err = std::cerr);
+
+// print timings in their format, nothing when none
+void printTimings(const Timings &timings, std::ostream &out = std::cout);
+
 #endif //XLAYOUTDISPLAY_LAYOUT_H
@@ -18,21 +18,14 @@
 
 #include <memory>
 #include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
 
-// sorting function for shared pointers... this must be in STL somewhere...
-template<typename T>
-inline bool sortSharedPtr(const std::shared_ptr<T> &l, const std::shared_ptr<T> &r) {
-    return (*l) < (*r);
-}
-
-// copy list of shared_ptr, reverse sort it, return it as const
-template<typename T>
-inline const std::list<std::shared_ptr<const T>> reverseSort(const std::list<std::shared_ptr<const T>> &list) {
-    std::list<std::shared_ptr<const T>> sorted = list;
-    sorted.sort(sortSharedPtr<const T>);
-    sorted.reverse();
-    return sorted;
-}
+#define FNV1A_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_PRIME 0x100000001b3ULL
 
 // return an absolute UNIX path for a relative path in the user env $HOME
 inline const std::string resolveTildePath(const char *homeRelativePath) {
@@ -41,4 +34,14 @@ inline const std::string resolveTildePath(const char *homeRelativePath) {
     return std::string(settingsFilePath);
 }
 
+// 64 bit FNV-1a hash of data, continuing from hash
+inline uint64_t fnv1a(const void *data, const size_t length, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
 #endif //XLAYOUTDISPLAY_STDUTIL_H
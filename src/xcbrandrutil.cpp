@@ -0,0 +1,401 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "xcbrandrutil.h"
+#include "xrandrrutil.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+using namespace std;
+
+// the base block and as many extension blocks as it may declare, so that any EDID is fetched whole in one request
+#define EDID_MAX_BLOCKS 256
+#define EDID_MAX_LENGTH_CARD32 (EDID_MAX_BLOCKS * EDID_BLOCK_LENGTH / 4)
+
+// name used by drivers predating RandR 1.3
+#define EDID_LEGACY_PROPERTY "EDID_DATA"
+
+XRRModeInfo modeInfoFromXcb(const xcb_randr_mode_info_t &modeInfo) {
+    XRRModeInfo xrrModeInfo{};
+    xrrModeInfo.id = modeInfo.id;
+    xrrModeInfo.width = modeInfo.width;
+    xrrModeInfo.height = modeInfo.height;
+    xrrModeInfo.dotClock = modeInfo.dot_clock;
+    xrrModeInfo.hSyncStart = modeInfo.hsync_start;
+    xrrModeInfo.hSyncEnd = modeInfo.hsync_end;
+    xrrModeInfo.hTotal = modeInfo.htotal;
+    xrrModeInfo.hSkew = modeInfo.hskew;
+    xrrModeInfo.vSyncStart = modeInfo.vsync_start;
+    xrrModeInfo.vSyncEnd = modeInfo.vsync_end;
+    xrrModeInfo.vTotal = modeInfo.vtotal;
+    xrrModeInfo.nameLength = modeInfo.name_len;
+    xrrModeInfo.modeFlags = modeInfo.mode_flags;
+    return xrrModeInfo;
+}
+
+bool edidPropertyName(const string &name) {
+    return strcasestr(name.c_str(), "EDID") != nullptr;
+}
+
+// requests whose replies have not yet been collected, discarded on destruction so that a failure part way through a
+// batch leaves no replies on the connection
+class PendingReplies {
+public:
+    explicit PendingReplies(xcb_connection_t *conn) : conn(conn) {}
+
+    PendingReplies(const PendingReplies &) = delete;
+
+    PendingReplies &operator=(const PendingReplies &) = delete;
+
+    ~PendingReplies() {
+        for (const auto &sequence : sequences)
+            xcb_discard_reply(conn, sequence);
+    }
+
+    template<typename Cookie>
+    const Cookie &add(const Cookie &cookie) {
+        sequences.insert(cookie.sequence);
+        return cookie;
+    }
+
+    // the reply is about to be collected
+    template<typename Cookie>
+    const Cookie &collect(const Cookie &cookie) {
+        sequences.erase(cookie.sequence);
+        return cookie;
+    }
+
+private:
+    xcb_connection_t *conn;
+    set<unsigned int> sequences;
+};
+
+RandrState::RandrState(xcb_connection_t *conn, Atoms &atoms, XTraffic &traffic, const xcb_window_t &root,
+                       const bool &probe, const set<RROutput> &skip) {
+
+    // EDID atoms and the primary are looked up alongside the resources, so that EDID may be fetched later without
+    // waiting for them; the atoms will not exist when no output has ever provided EDID
+    PendingReplies pending(conn);
+    atoms.request({RR_PROPERTY_RANDR_EDID, EDID_LEGACY_PROPERTY});
+    const xcb_randr_get_output_primary_cookie_t primaryCookie =
+            pending.add(traffic.sent(xcb_randr_get_output_primary(conn, root)));
+
+    // current resources are cheap, and are trusted unless empty
+    if (!probe) {
+        const XcbReply<xcb_randr_get_screen_resources_current_reply_t> reply(
+                xcb_randr_get_screen_resources_current_reply(
+                        conn, traffic.awaiting(traffic.sent(xcb_randr_get_screen_resources_current(conn, root))),
+                        nullptr), free);
+        if (reply) {
+            setResources(reply->timestamp, reply->config_timestamp,
+                         xcb_randr_get_screen_resources_current_crtcs(reply.get()),
+                         xcb_randr_get_screen_resources_current_crtcs_length(reply.get()),
+                         xcb_randr_get_screen_resources_current_outputs(reply.get()),
+                         xcb_randr_get_screen_resources_current_outputs_length(reply.get()),
+                         xcb_randr_get_screen_resources_current_modes(reply.get()),
+                         xcb_randr_get_screen_resources_current_modes_length(reply.get()));
+        }
+        empty = resourcesEmpty(&screenResources);
+    }
+
+    // poll the hardware
+    if (probe || empty) {
+        const XcbReply<xcb_randr_get_screen_resources_reply_t> reply(
+                xcb_randr_get_screen_resources_reply(
+                        conn, traffic.awaiting(traffic.sent(xcb_randr_get_screen_resources(conn, root))), nullptr),
+                free);
+        if (!reply)
+            throw runtime_error("unable to retrieve RandR screen resources");
+        setResources(reply->timestamp, reply->config_timestamp,
+                     xcb_randr_get_screen_resources_crtcs(reply.get()),
+                     xcb_randr_get_screen_resources_crtcs_length(reply.get()),
+                     xcb_randr_get_screen_resources_outputs(reply.get()),
+                     xcb_randr_get_screen_resources_outputs_length(reply.get()),
+                     xcb_randr_get_screen_resources_modes(reply.get()),
+                     xcb_randr_get_screen_resources_modes_length(reply.get()));
+        probed = true;
+    }
+
+    const XcbReply<xcb_randr_get_output_primary_reply_t> primaryReply(
+            xcb_randr_get_output_primary_reply(conn, traffic.awaiting(pending.collect(primaryCookie)), nullptr), free);
+    if (primaryReply)
+        primary = primaryReply->output;
+
+    edidAtom = atoms.atom(RR_PROPERTY_RANDR_EDID);
+    if (edidAtom == XCB_ATOM_NONE)
+        edidAtom = atoms.atom(EDID_LEGACY_PROPERTY);
+
+    // send all output requests before waiting for any replies
+    const size_t noutput = outputIds.size();
+    queried.resize(noutput);
+    vector<xcb_randr_get_output_info_cookie_t> outputInfoCookies(noutput);
+    for (size_t i = 0; i < noutput; i++) {
+        queried[i] = !skip.count(outputIds[i]);
+        if (!queried[i])
+            continue;
+        outputInfoCookies[i] = pending.add(traffic.sent(
+                xcb_randr_get_output_info(conn, outputIds[i], screenResources.configTimestamp)));
+    }
+
+    // all CRTCs are requested at the same time when everything is wanted
+    vector<xcb_randr_get_crtc_info_cookie_t> crtcInfoCookies;
+    if (skip.empty()) {
+        for (const auto &crtc : crtcIds) {
+            crtcInfoCookies.push_back(pending.add(
+                    traffic.sent(xcb_randr_get_crtc_info(conn, crtc, screenResources.configTimestamp))));
+        }
+    }
+
+    // collect outputs
+    outputInfos.resize(noutput);
+    outputNames.resize(noutput);
+    outputCrtcs.resize(noutput);
+    outputClones.resize(noutput);
+    outputModes.resize(noutput);
+    for (size_t i = 0; i < noutput; i++) {
+        if (!queried[i])
+            continue;
+        const XcbReply<xcb_randr_get_output_info_reply_t> reply(
+                xcb_randr_get_output_info_reply(conn, traffic.awaiting(pending.collect(outputInfoCookies[i])), nullptr),
+                free);
+        if (!reply)
+            throw runtime_error("unable to retrieve RandR output info for output " + to_string(outputIds[i]));
+
+        const auto *name = reinterpret_cast<const char *>(xcb_randr_get_output_info_name(reply.get()));
+        outputNames[i] = string(name, (size_t) xcb_randr_get_output_info_name_length(reply.get()));
+
+        const xcb_randr_crtc_t *crtcs = xcb_randr_get_output_info_crtcs(reply.get());
+        outputCrtcs[i].assign(crtcs, crtcs + xcb_randr_get_output_info_crtcs_length(reply.get()));
+
+        const xcb_randr_output_t *clones = xcb_randr_get_output_info_clones(reply.get());
+        outputClones[i].assign(clones, clones + xcb_randr_get_output_info_clones_length(reply.get()));
+
+        const xcb_randr_mode_t *modes = xcb_randr_get_output_info_modes(reply.get());
+        outputModes[i].assign(modes, modes + xcb_randr_get_output_info_modes_length(reply.get()));
+
+        XRROutputInfo &outputInfo = outputInfos[i];
+        outputInfo.timestamp = reply->timestamp;
+        outputInfo.crtc = reply->crtc;
+        outputInfo.name = &outputNames[i][0];
+        outputInfo.nameLen = (int) outputNames[i].size();
+        outputInfo.mm_width = reply->mm_width;
+        outputInfo.mm_height = reply->mm_height;
+        outputInfo.connection = reply->connection;
+        outputInfo.subpixel_order = reply->subpixel_order;
+        outputInfo.ncrtc = (int) outputCrtcs[i].size();
+        outputInfo.crtcs = outputCrtcs[i].data();
+        outputInfo.nclone = (int) outputClones[i].size();
+        outputInfo.clones = outputClones[i].data();
+        outputInfo.nmode = (int) outputModes[i].size();
+        outputInfo.npreferred = reply->num_preferred;
+        outputInfo.modes = outputModes[i].data();
+    }
+
+    // collect CRTCs, requesting only those in use by queried outputs when skipping
+    if (skip.empty()) {
+        crtcInfoIds = crtcIds;
+    } else {
+        for (size_t i = 0; i < noutput; i++) {
+            if (queried[i] && outputInfos[i].crtc &&
+                find(crtcInfoIds.begin(), crtcInfoIds.end(), outputInfos[i].crtc) == crtcInfoIds.end())
+                crtcInfoIds.push_back(outputInfos[i].crtc);
+        }
+        for (const auto &crtc : crtcInfoIds) {
+            crtcInfoCookies.push_back(pending.add(
+                    traffic.sent(xcb_randr_get_crtc_info(conn, crtc, screenResources.configTimestamp))));
+        }
+    }
+    const size_t ncrtc = crtcInfoIds.size();
+    crtcInfos.resize(ncrtc);
+    crtcOutputs.resize(ncrtc);
+    crtcPossibles.resize(ncrtc);
+    for (size_t i = 0; i < ncrtc; i++) {
+        const XcbReply<xcb_randr_get_crtc_info_reply_t> reply(
+                xcb_randr_get_crtc_info_reply(conn, traffic.awaiting(pending.collect(crtcInfoCookies[i])), nullptr),
+                free);
+        if (!reply)
+            throw runtime_error("unable to retrieve RandR CRTC info for CRTC " + to_string(crtcInfoIds[i]));
+
+        const xcb_randr_output_t *outputs = xcb_randr_get_crtc_info_outputs(reply.get());
+        crtcOutputs[i].assign(outputs, outputs + xcb_randr_get_crtc_info_outputs_length(reply.get()));
+
+        const xcb_randr_output_t *possibles = xcb_randr_get_crtc_info_possible(reply.get());
+        crtcPossibles[i].assign(possibles, possibles + xcb_randr_get_crtc_info_possible_length(reply.get()));
+
+        XRRCrtcInfo &crtcInfo = crtcInfos[i];
+        crtcInfo.timestamp = reply->timestamp;
+        crtcInfo.x = reply->x;
+        crtcInfo.y = reply->y;
+        crtcInfo.width = reply->width;
+        crtcInfo.height = reply->height;
+        crtcInfo.mode = reply->mode;
+        crtcInfo.rotation = reply->rotation;
+        crtcInfo.noutput = (int) crtcOutputs[i].size();
+        crtcInfo.outputs = crtcOutputs[i].data();
+        crtcInfo.rotations = reply->rotations;
+        crtcInfo.npossible = (int) crtcPossibles[i].size();
+        crtcInfo.possible = crtcPossibles[i].data();
+    }
+}
+
+const XRRCrtcInfo *RandrState::crtcInfo(const RRCrtc &crtc) const {
+    for (size_t i = 0; i < crtcInfoIds.size(); i++)
+        if (crtcInfoIds[i] == crtc)
+            return &crtcInfos[i];
+    return nullptr;
+}
+
+void RandrState::setResources(const xcb_timestamp_t &timestamp, const xcb_timestamp_t &configTimestamp,
+                              const xcb_randr_crtc_t *crtcs, const int &ncrtc,
+                              const xcb_randr_output_t *outputs, const int &noutput,
+                              const xcb_randr_mode_info_t *modes, const int &nmode) {
+    crtcIds.assign(crtcs, crtcs + ncrtc);
+    outputIds.assign(outputs, outputs + noutput);
+    modeInfos.clear();
+    for (int i = 0; i < nmode; i++)
+        modeInfos.push_back(modeInfoFromXcb(modes[i]));
+
+    screenResources.timestamp = timestamp;
+    screenResources.configTimestamp = configTimestamp;
+    screenResources.ncrtc = ncrtc;
+    screenResources.crtcs = crtcIds.data();
+    screenResources.noutput = noutput;
+    screenResources.outputs = outputIds.data();
+    screenResources.nmode = nmode;
+    screenResources.modes = modeInfos.data();
+}
+
+EdidBatch::~EdidBatch() {
+    for (const auto &output : outputs)
+        if (output.sent)
+            xcb_discard_reply(session->conn, output.cookie.sequence);
+}
+
+void EdidBatch::request(const size_t &i) {
+    Pending &output = outputs[i];
+    if (output.requested)
+        return;
+    output.requested = true;
+    if (edidAtom != XCB_ATOM_NONE) {
+        output.cookie = requestProperty(output.rrOutput, edidAtom);
+        output.sent = true;
+    }
+}
+
+shared_ptr<const Edid> EdidBatch::load(const size_t &i) {
+    request(i);
+    if (!outputs[i].done)
+        collect();
+    if (outputs[i].error)
+        rethrow_exception(outputs[i].error);
+    return outputs[i].edid;
+}
+
+void EdidBatch::collect() {
+    xcb_connection_t *conn = session->conn;
+
+    // the replies to everything requested so far
+    vector<size_t> missing;
+    for (size_t i = 0; i < outputs.size(); i++) {
+        Pending &output = outputs[i];
+        if (!output.requested || output.done)
+            continue;
+        output.done = true;
+        if (output.sent) {
+            output.sent = false;
+            receive(output, output.cookie);
+        }
+        if (!output.edid && !output.error)
+            missing.push_back(i);
+    }
+    if (missing.empty())
+        return;
+
+    // EDID-like names in the properties of those without, which may indicate that the driver uses an unexpected name
+    vector<xcb_randr_list_output_properties_cookie_t> listCookies;
+    for (const auto &i : missing)
+        listCookies.push_back(session->traffic.sent(xcb_randr_list_output_properties(conn, outputs[i].rrOutput)));
+    vector<vector<xcb_atom_t>> candidates;
+    vector<xcb_atom_t> allCandidates;
+    for (const auto &cookie : listCookies) {
+        const XcbReply<xcb_randr_list_output_properties_reply_t> reply(
+                xcb_randr_list_output_properties_reply(conn, session->traffic.awaiting(cookie), nullptr), free);
+        candidates.emplace_back();
+        if (!reply)
+            continue;
+        const xcb_atom_t *propertyAtoms = xcb_randr_list_output_properties_atoms(reply.get());
+        candidates.back().assign(propertyAtoms,
+                                 propertyAtoms + xcb_randr_list_output_properties_atoms_length(reply.get()));
+        allCandidates.insert(allCandidates.end(), candidates.back().begin(), candidates.back().end());
+    }
+    const vector<string> names = session->atoms.names(allCandidates);
+
+    // fetch the first of each
+    vector<pair<size_t, xcb_randr_get_output_property_cookie_t>> fallbacks;
+    size_t n = 0;
+    for (size_t j = 0; j < missing.size(); j++) {
+        xcb_atom_t fallback = XCB_ATOM_NONE;
+        for (const auto &candidate : candidates[j])
+            if (edidPropertyName(names[n++]) && candidate != edidAtom && fallback == XCB_ATOM_NONE)
+                fallback = candidate;
+        if (fallback != XCB_ATOM_NONE)
+            fallbacks.emplace_back(missing[j], requestProperty(outputs[missing[j]].rrOutput, fallback));
+    }
+    for (const auto &fallback : fallbacks)
+        receive(outputs[fallback.first], fallback.second);
+}
+
+xcb_randr_get_output_property_cookie_t EdidBatch::requestProperty(const RROutput &rrOutput,
+                                                                  const xcb_atom_t &property) {
+    return session->traffic.sent(
+            xcb_randr_get_output_property(session->conn, (xcb_randr_output_t) rrOutput, property, XCB_ATOM_ANY,
+                                          0, EDID_MAX_LENGTH_CARD32, 0, 0));
+}
+
+void EdidBatch::receive(Pending &output, const xcb_randr_get_output_property_cookie_t &cookie) {
+    XcbReply<xcb_randr_get_output_property_reply_t> reply(
+            xcb_randr_get_output_property_reply(session->conn, session->traffic.awaiting(cookie), nullptr), free);
+
+    // missing or malformed is not an error
+    if (!reply || reply->type == XCB_ATOM_NONE || reply->format != 8)
+        return;
+    const int length = xcb_randr_get_output_property_data_length(reply.get());
+    if (length <= 0)
+        return;
+
+    // the data is shared with the reply, which lives as long as the Edid
+    // too short is reported only when this output's EDID is used
+    const shared_ptr<xcb_randr_get_output_property_reply_t> shared(reply.release(), free);
+    try {
+        output.edid = make_shared<Edid>(
+                shared_ptr<const unsigned char>(shared, xcb_randr_get_output_property_data(shared.get())),
+                (size_t) length, output.name.c_str());
+    } catch (const invalid_argument &) {
+        output.error = current_exception();
+    }
+}
+
+Lazy<const Edid> lazyEdid(const shared_ptr<EdidBatch> &batch, const RROutput &rrOutput, const string &name) {
+    const size_t i = batch->outputs.size();
+    EdidBatch::Pending pending;
+    pending.rrOutput = rrOutput;
+    pending.name = name;
+    batch->outputs.push_back(pending);
+    return Lazy<const Edid>([batch, i]() { batch->request(i); }, [batch, i]() { return batch->load(i); });
+}
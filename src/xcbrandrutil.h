@@ -0,0 +1,163 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_XCBRANDRUTIL_H
+#define XLAYOUTDISPLAY_XCBRANDRUTIL_H
+
+#include "Atoms.h"
+#include "Edid.h"
+#include "Lazy.h"
+#include "Session.h"
+
+#include <X11/extensions/Xrandr.h>
+#include <xcb/randr.h>
+
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// replies are malloced by xcb and must be freed
+template<typename T>
+using XcbReply = std::unique_ptr<T, decltype(&free)>;
+
+// convert an xcb mode to its Xrandr equivalent; name is not populated
+XRRModeInfo modeInfoFromXcb(const xcb_randr_mode_info_t &modeInfo);
+
+// true if an output property name appears to hold EDID, case insensitive
+bool edidPropertyName(const std::string &name);
+
+// RandR state of a screen, retrieved using pipelined xcb requests and presented as Xrandr structures
+// all output and CRTC requests are sent at once, so discovery costs the same number of round trips regardless of the
+// number of outputs
+class RandrState {
+public:
+    // retrieve current resources unless probe is set or they are empty, in which case the hardware is polled
+    // EDID is not fetched, however its atom is resolved as edidAtom
+    // outputs in skip are not queried, nor are CRTCs other than those used by queried outputs; this costs an extra
+    // round trip
+    // requests are recorded in traffic
+    // throws runtime_error:
+    //   when RandR requests fail
+    RandrState(xcb_connection_t *conn, Atoms &atoms, XTraffic &traffic, const xcb_window_t &root, const bool &probe,
+               const std::set<RROutput> &skip = {});
+
+    RandrState(const RandrState &) = delete;
+
+    RandrState &operator=(const RandrState &) = delete;
+
+    // outputs, crtcs and modes are owned by this
+    const XRRScreenResources *resources() const { return &screenResources; }
+
+    // output information, in the order of resources()->outputs; nullptr when skipped
+    const XRROutputInfo *outputInfo(const int &i) const { return queried[i] ? &outputInfos[i] : nullptr; }
+
+    // nullptr when crtc is not present in resources or was not queried
+    const XRRCrtcInfo *crtcInfo(const RRCrtc &crtc) const;
+
+    // RandR EDID property, falling back to the legacy name; XCB_ATOM_NONE when neither exist
+    xcb_atom_t edidAtom = XCB_ATOM_NONE;
+
+    // current primary output, zero when none
+    RROutput primary = 0;
+
+    // true if the hardware was polled
+    bool probed = false;
+
+    // true if the hardware was polled as the current resources were empty
+    bool empty = false;
+
+private:
+    // replace resources with those from an xcb reply
+    void setResources(const xcb_timestamp_t &timestamp, const xcb_timestamp_t &configTimestamp,
+                      const xcb_randr_crtc_t *crtcs, const int &ncrtc,
+                      const xcb_randr_output_t *outputs, const int &noutput,
+                      const xcb_randr_mode_info_t *modes, const int &nmode);
+
+    XRRScreenResources screenResources{};
+    std::vector<RRCrtc> crtcIds;
+    std::vector<RROutput> outputIds;
+    std::vector<XRRModeInfo> modeInfos;
+
+    std::vector<bool> queried;
+    std::vector<XRROutputInfo> outputInfos;
+    std::vector<std::string> outputNames;
+    std::vector<std::vector<RRCrtc>> outputCrtcs;
+    std::vector<std::vector<RROutput>> outputClones;
+    std::vector<std::vector<RRMode>> outputModes;
+
+    std::vector<RRCrtc> crtcInfoIds;
+    std::vector<XRRCrtcInfo> crtcInfos;
+    std::vector<std::vector<RROutput>> crtcOutputs;
+    std::vector<std::vector<RROutput>> crtcPossibles;
+
+};
+
+// EDID of outputs discovered together, each requested only when first needed and viewing its X reply
+// the replies to all requests are collected together on first use; those outputs with no EDID under edidAtom then
+// have their properties scanned for another EDID name together, so that the fallback costs the same round trips
+// regardless of the number of outputs
+class EdidBatch {
+public:
+    EdidBatch(const std::shared_ptr<Session> &session, const xcb_atom_t &edidAtom) :
+            session(session), edidAtom(edidAtom) {}
+
+    EdidBatch(const EdidBatch &) = delete;
+
+    EdidBatch &operator=(const EdidBatch &) = delete;
+
+    // discards replies not yet collected
+    ~EdidBatch();
+
+private:
+    struct Pending {
+        RROutput rrOutput = 0;
+        std::string name;
+        bool requested = false;
+        bool sent = false;
+        bool done = false;
+        xcb_randr_get_output_property_cookie_t cookie{};
+        std::shared_ptr<const Edid> edid;
+        std::exception_ptr error;
+    };
+
+    void request(const size_t &i);
+
+    std::shared_ptr<const Edid> load(const size_t &i);
+
+    // collect all requested, then look for those that have none under other names
+    void collect();
+
+    xcb_randr_get_output_property_cookie_t requestProperty(const RROutput &rrOutput, const xcb_atom_t &property);
+
+    void receive(Pending &output, const xcb_randr_get_output_property_cookie_t &cookie);
+
+    const std::shared_ptr<Session> session;
+    const xcb_atom_t edidAtom;
+    std::vector<Pending> outputs;
+
+    friend Lazy<const Edid> lazyEdid(const std::shared_ptr<EdidBatch> &batch, const RROutput &rrOutput,
+                                     const std::string &name);
+};
+
+// EDID of rrOutput, loaded along with the others in batch
+// request() the EDID of many outputs before using any, so that they are fetched with a single round trip
+// throws invalid_argument on use:
+//   EDID too short
+Lazy<const Edid> lazyEdid(const std::shared_ptr<EdidBatch> &batch, const RROutput &rrOutput, const std::string &name);
+
+#endif //XLAYOUTDISPLAY_XCBRANDRUTIL_H
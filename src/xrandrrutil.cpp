@@ -14,10 +14,14 @@
    limitations under the License.
 */
 #include "xrandrrutil.h"
+#include "xcbrandrutil.h"
 
+#include <map>
 #include <sstream>
 #include <cstring>
 #include <cmath>
+#include <chrono>
+#include <iomanip>
 #include <system_error>
 
 using namespace std;
@@ -59,6 +63,14 @@ const string renderXrandrCmd(const list<shared_ptr<Output>> &outputs, const shar
             }
             ss << " --pos ";
             ss << output->desiredPos->x << "x" << output->desiredPos->y;
+            if (output->desiredCrtc) {
+                ss << " --crtc 0x" << hex << output->desiredCrtc << dec;
+            }
+            if (output->desiredScaleFrom.first && output->desiredScaleFrom.second) {
+                ss << " --scale-from " << output->desiredScaleFrom.first << "x" << output->desiredScaleFrom.second;
+            } else if (output->currentScaleFrom.first && output->currentScaleFrom.second) {
+                ss << " --transform none";
+            }
             if (output == primary) {
                 ss << " --primary";
             }
@@ -87,103 +99,175 @@ Mode *modeFromXRR(RRMode id, const XRRScreenResources *resources) {
     return new Mode(id, modeInfo->width, modeInfo->height, refreshFromModeInfo(*modeInfo));
 }
 
-// build a list of Output based on the current and possible state of the world
-const list<shared_ptr<Output>> discoverOutputs() {
-    list<shared_ptr<Output>> outputs;
+bool resourcesEmpty(const XRRScreenResources *resources) {
+    return resources == nullptr || resources->noutput == 0 || resources->nmode == 0;
+}
+
+const shared_ptr<Output> outputFromXRR(ModeIndex &modeIndex, const RROutput &rrOutput, const XRROutputInfo *outputInfo,
+                                       const XRRCrtcInfo *crtcInfo, const Lazy<const Edid> &edid) {
+    Output::State state;
+    vector<shared_ptr<const Mode>> modes;
+    std::shared_ptr<const Mode> currentMode, preferredMode;
+    shared_ptr<Pos> currentPos;
+    pair<unsigned int, unsigned int> currentScaleFrom;
+
+    // current state
+    const char *name = outputInfo->name;
+    if (outputInfo->crtc != 0) {
+        // active outputs have CRTC info
+        state = Output::active;
+        if (!crtcInfo)
+            throw invalid_argument("active Output '" + string(name) + "' has no CRTC info");
+
+        // current position and mode
+        currentPos = make_shared<Pos>(crtcInfo->x, crtcInfo->y);
+        currentMode = modeIndex.mode(crtcInfo->mode);
+
+        // a CRTC covering an area other than its mode's is scaled, unless it is rotated on its side
+        if (currentMode && !(crtcInfo->rotation & (RR_Rotate_90 | RR_Rotate_270)) &&
+            (crtcInfo->width != currentMode->width || crtcInfo->height != currentMode->height))
+            currentScaleFrom = make_pair(crtcInfo->width, crtcInfo->height);
+
+        if (outputInfo->nmode == 0) {
+            // output is active but has been disconnected
+            state = Output::disconnected;
+        }
+    } else if (outputInfo->nmode != 0) {
+        // inactive connected outputs have modes available
+        state = Output::connected;
+    } else {
+        state = Output::disconnected;
+    }
+
+    // add available modes, shared with the current mode and other outputs
+    modes.reserve((size_t) outputInfo->nmode);
+    for (int j = 0; j < outputInfo->nmode; j++) {
+        const shared_ptr<const Mode> &mode = modeIndex.mode(outputInfo->modes[j]);
+        modes.push_back(mode);
 
-    // get the display
-    Display *dpy = XOpenDisplay(nullptr);
-    if (!dpy)
-        throw domain_error(string("unable to open display '") + XDisplayName(nullptr) + "'");
+        // (optional) preferred mode based on outputInfo->modes indexed by 1
+        if (outputInfo->npreferred == j + 1)
+            preferredMode = mode;
+    }
 
-    // get the root window
-    int screen = DefaultScreen(dpy);
-    Window rootWindow = RootWindow(dpy, screen);
+    const shared_ptr<Output> output = make_shared<Output>(name, state, modes, currentMode, preferredMode, currentPos,
+                                                          edid);
+    output->rrOutput = rrOutput;
+    output->crtc = outputInfo->crtc;
+    output->crtcs.assign(outputInfo->crtcs, outputInfo->crtcs + outputInfo->ncrtc);
+    output->clones.assign(outputInfo->clones, outputInfo->clones + outputInfo->nclone);
+    output->currentScaleFrom = currentScaleFrom;
+    return output;
+}
 
-    // get RandR resources
-    XRRScreenResources *screenResources = XRRGetScreenResources(dpy, rootWindow);
+// build a list of Output based on the current and possible state of the world
+const list<shared_ptr<Output>> discoverOutputs(const shared_ptr<Session> &session, const bool &probe,
+                                               string *explaination) {
+    list<shared_ptr<Output>> outputs;
+    stringstream verbose;
+
+    const auto start = chrono::steady_clock::now();
+
+    // retrieve everything at once, only polling the hardware when asked or the server's view is unusable
+    const RandrState state(session->conn, session->atoms, session->traffic, (xcb_window_t) session->root, probe);
+    if (state.empty) {
+        verbose << "probed hardware as current resources are empty";
+    } else if (state.probed) {
+        verbose << "probed hardware";
+    } else {
+        verbose << "used current resources";
+    }
 
     // iterate outputs
+    const XRRScreenResources *screenResources = state.resources();
+    ModeIndex modeIndex(screenResources);
+    const shared_ptr<EdidBatch> edids = make_shared<EdidBatch>(session, state.edidAtom);
     for (int i = 0; i < screenResources->noutput; i++) {
-        Output::State state;
-        list<std::shared_ptr<const Mode>> modes;
-        std::shared_ptr<Mode> currentMode, preferredMode;
-        shared_ptr<Pos> currentPos;
-        shared_ptr<Edid> edid;
-
-        // current state
-        const RROutput rrOutput = screenResources->outputs[i];
-        const XRROutputInfo *outputInfo = XRRGetOutputInfo(dpy, screenResources, rrOutput);
-        const char *name = outputInfo->name;
-        RRMode rrMode = 0;
-        if (outputInfo->crtc != 0) {
-            // active outputs have CRTC info
-            state = Output::active;
-
-            // current position and mode
-            XRRCrtcInfo *crtcInfo = XRRGetCrtcInfo(dpy, screenResources, outputInfo->crtc);
-            currentPos = make_shared<Pos>(crtcInfo->x, crtcInfo->y);
-            rrMode = crtcInfo->mode;
-            currentMode = shared_ptr<Mode>(modeFromXRR(rrMode, screenResources));
-
-            if (outputInfo->nmode == 0) {
-                // output is active but has been disconnected
-                state = Output::disconnected;
-            }
-        } else if (outputInfo->nmode != 0) {
-            // inactive connected outputs have modes available
-            state = Output::connected;
-        } else {
-            state = Output::disconnected;
-        }
+        const XRROutputInfo *outputInfo = state.outputInfo(i);
 
-        // iterate all properties to find EDID; XRRQueryOutputProperty fails when queried with XInternAtom
-        int nprop;
-        Atom *atoms = XRRListOutputProperties(dpy, rrOutput, &nprop);
-        for (int j = 0; j < nprop; j++) {
-            Atom atom = atoms[j];
-            char *atomName = XGetAtomName(dpy, atom);
-
-            // drill down on Edid
-            if (strcmp(atomName, RR_PROPERTY_RANDR_EDID) == 0) {
-
-                // retrieve property specifics
-                Atom actualType;
-                int actualFormat;
-                unsigned long nitems, bytesAfter;
-                unsigned char *prop;
-                XRRGetOutputProperty(dpy, rrOutput, atom,
-                                     0, // offset
-                                     64, // length in CARD32 - EDID 2.0 max length is 256 bytes
-                                     false, // delete
-                                     false, // pending
-                                     AnyPropertyType, &actualType, &actualFormat, &nitems, &bytesAfter, &prop
-                );
-
-                // record Edid
-                edid = make_shared<Edid>(prop, nitems, name);
-            }
-        }
+        // Edid is fetched when first needed; disconnected outputs have none
+        Lazy<const Edid> edid;
+        if (outputInfo->connection != RR_Disconnected)
+            edid = lazyEdid(edids, screenResources->outputs[i], outputInfo->name);
+
+        // add the output
+        const shared_ptr<Output> output = outputFromXRR(modeIndex, screenResources->outputs[i], outputInfo,
+                                                        state.crtcInfo(outputInfo->crtc), edid);
+        output->currentPrimary = output->rrOutput == state.primary;
+        outputs.push_back(output);
+    }
+
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    verbose << "; discovered " << outputs.size() << " outputs in " << fixed << setprecision(1) << elapsed.count() << "ms";
+    *explaination = verbose.str();
 
-        // add available modes
-        for (int j = 0; j < outputInfo->nmode; j++) {
+    return outputs;
+}
 
-            // add to modes
-            const auto &mode = shared_ptr<Mode>(modeFromXRR(outputInfo->modes[j], screenResources));
-            modes.push_back(mode);
+const list<shared_ptr<Output>> rediscoverOutputs(const shared_ptr<Session> &session,
+                                                 const list<shared_ptr<Output>> &previous,
+                                                 const set<RROutput> &changed,
+                                                 string *explaination) {
+    list<shared_ptr<Output>> outputs;
+    stringstream verbose;
 
-            // (optional) preferred mode based on outputInfo->modes indexed by 1
-            if (outputInfo->npreferred == j + 1)
-                preferredMode = mode;
+    const auto start = chrono::steady_clock::now();
 
-            // replace currentMode with the one from the list
-            if (mode->rrMode == rrMode)
-                currentMode = mode;
+    // skip everything previously discovered that has not changed
+    map<RROutput, shared_ptr<Output>> reusable;
+    set<RROutput> skip;
+    for (const auto &output : previous) {
+        if (!changed.count(output->rrOutput)) {
+            reusable[output->rrOutput] = output;
+            skip.insert(output->rrOutput);
         }
-
-        // add the output
-        outputs.push_back(make_shared<Output>(name, state, modes, currentMode, preferredMode, currentPos, edid));
     }
+    const RandrState state(session->conn, session->atoms, session->traffic, (xcb_window_t) session->root, false,
+                           skip);
+
+    // iterate outputs, reusing or building as needed
+    const XRRScreenResources *screenResources = state.resources();
+    ModeIndex modeIndex(screenResources);
+    const shared_ptr<EdidBatch> edids = make_shared<EdidBatch>(session, state.edidAtom);
+    unsigned int queried = 0;
+    for (int i = 0; i < screenResources->noutput; i++) {
+        const XRROutputInfo *outputInfo = state.outputInfo(i);
+
+        shared_ptr<Output> output;
+        if (outputInfo) {
+            Lazy<const Edid> edid;
+            if (outputInfo->connection != RR_Disconnected)
+                edid = lazyEdid(edids, screenResources->outputs[i], outputInfo->name);
+            output = outputFromXRR(modeIndex, screenResources->outputs[i], outputInfo,
+                                   state.crtcInfo(outputInfo->crtc), edid);
+            queried++;
+        } else {
+            output = reusable[screenResources->outputs[i]];
+            output->resetDesired();
+        }
+        output->currentPrimary = output->rrOutput == state.primary;
+        outputs.push_back(output);
+    }
+
+    const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    verbose << "rediscovered " << queried << " of " << outputs.size() << " outputs in " << fixed << setprecision(1)
+            << elapsed.count() << "ms";
+    *explaination = verbose.str();
 
     return outputs;
 }
+
+const set<RROutput> changedOutputs(const list<shared_ptr<Output>> &previous,
+                                   const set<RROutput> &changedOutputs,
+                                   const set<RRCrtc> &changedCrtcs) {
+    set<RROutput> changed = changedOutputs;
+    for (const auto &output : previous)
+        if (output->crtc && changedCrtcs.count(output->crtc))
+            changed.insert(output->rrOutput);
+    return changed;
+}
+
+void requestEdids(const list<shared_ptr<Output>> &outputs) {
+    for (const auto &output : outputs)
+        output->edid.request();
+}
@@ -17,6 +17,10 @@
 #define XLAYOUTDISPLAY_XRANDRUTIL_H
 
 #include "Output.h"
+#include "ModeIndex.h"
+#include "Session.h"
+
+#include <set>
 
 // v refresh frequency in even Hz, zero if modeInfo is NULL
 unsigned int refreshFromModeInfo(const XRRModeInfo &modeInfo);
@@ -24,14 +28,53 @@ unsigned int refreshFromModeInfo(const XRRModeInfo &modeInfo);
 // render xrandr cmd to layout outputs
 // will activate only if desiredActive, desiredMode, desiredPos are set
 // desiredPrimary is only set if activated
+// scaled outputs are scaled from their desired area, others that are currently scaled have their transform removed
 const std::string renderXrandrCmd(const std::list<std::shared_ptr<Output>> &outputs, const std::shared_ptr<Output> &primary, const long &dpi, const long &rate);
 
+// a new Mode for id; use ModeIndex to share Modes between outputs
 // throws invalid_argument:
 //   null resources
 //   id not found in resources
 Mode *modeFromXRR(RRMode id, const XRRScreenResources *resources);
 
+// build an Output from RandR output info; crtcInfo is needed only for active outputs
+// modes are shared with all other outputs built from modeIndex
+// the output is currently scaled when its CRTC covers an area other than that of its mode
+// throws invalid_argument:
+//   active output without crtcInfo
+//   output or CRTC mode not found in modeIndex
+const std::shared_ptr<Output> outputFromXRR(ModeIndex &modeIndex, const RROutput &rrOutput,
+                                            const XRROutputInfo *outputInfo, const XRRCrtcInfo *crtcInfo,
+                                            const Lazy<const Edid> &edid);
+
+// true when RandR resources are missing or have no outputs or modes, as when the server has not yet probed the hardware
+// this is the only check made: non-empty current resources are trusted, as the server updates them itself when it is
+// notified of a hotplug; --probe is needed for hardware that changes without notification
+bool resourcesEmpty(const XRRScreenResources *resources);
+
 // build a list of Output based on the current and possible state of the world
-const std::list<std::shared_ptr<Output>> discoverOutputs();
+// Edid is not fetched until first used
+// the X server's current resources are used unless probe is set or they are empty, in which case the hardware is polled
+// explaination will be set to how the resources were retrieved and how long discovery took
+const std::list<std::shared_ptr<Output>> discoverOutputs(const std::shared_ptr<Session> &session, const bool &probe,
+                                                         std::string *explaination);
+
+// rediscover outputs after RandR reported that changed outputs have changed, querying only those outputs, outputs not
+// in previous and the CRTCs that they use
+// unchanged outputs in previous are reused along with their Edid, with their desired state reset; outputs no longer
+// present are dropped
+// explaination will be set to how many outputs were queried and how long rediscovery took
+const std::list<std::shared_ptr<Output>> rediscoverOutputs(const std::shared_ptr<Session> &session,
+                                                           const std::list<std::shared_ptr<Output>> &previous,
+                                                           const std::set<RROutput> &changed,
+                                                           std::string *explaination);
+
+// outputs in changedOutputs plus those in previous that were using a CRTC in changedCrtcs
+const std::set<RROutput> changedOutputs(const std::list<std::shared_ptr<Output>> &previous,
+                                        const std::set<RROutput> &changedOutputs,
+                                        const std::set<RRCrtc> &changedCrtcs);
+
+// request the Edid of all outputs not yet loaded, so that they are fetched with a single round trip when first used
+void requestEdids(const std::list<std::shared_ptr<Output>> &outputs);
 
 #endif //XLAYOUTDISPLAY_XRANDRUTIL_H
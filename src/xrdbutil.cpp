@@ -16,11 +16,19 @@
 #include "xrdbutil.h"
 
 #include "Output.h"
+#include "xcbrandrutil.h"
 
+#include <cstdlib>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
+#define XFT_DPI "Xft.dpi"
+
+// as per xrdb, read in as many of these as needed
+#define RESOURCE_MANAGER_MAX_LENGTH_CARD32 100000000
+
 const std::string renderXrdbCmd(const long &dpi) {
     stringstream ss;
     ss << "echo \"Xft.dpi: "
@@ -28,3 +36,69 @@ const std::string renderXrdbCmd(const long &dpi) {
        << "\" | xrdb -merge";
     return ss.str();
 }
+
+const string mergeXftDpi(const string &resources, const long &dpi) {
+    stringstream merged;
+    bool replaced = false;
+
+    istringstream lines(resources);
+    string line;
+    while (getline(lines, line)) {
+
+        // resource name, ignoring whitespace around it
+        const size_t colon = line.find(':');
+        const size_t begin = line.find_first_not_of(" \t");
+        const size_t end = colon == string::npos ? string::npos : line.find_last_not_of(" \t", colon - 1);
+        const bool xftDpi = colon != string::npos && begin < colon && end != string::npos &&
+                            line.compare(begin, end - begin + 1, XFT_DPI) == 0;
+
+        if (!xftDpi) {
+            merged << line << '\n';
+        } else if (!replaced) {
+            merged << XFT_DPI << ":\t" << dpi << '\n';
+            replaced = true;
+        }
+    }
+    if (!replaced) {
+        merged << XFT_DPI << ":\t" << dpi << '\n';
+    }
+
+    return merged.str();
+}
+
+bool applyXftDpi(const shared_ptr<Session> &session, const long &dpi) {
+    xcb_connection_t *conn = session->conn;
+
+    // current resources in full; there are none when the property does not exist
+    string resources;
+    XTraffic &traffic = session->traffic;
+    uint32_t bytesAfter;
+    do {
+        const XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(
+                conn, traffic.awaiting(traffic.sent(
+                        xcb_get_property(conn, 0, (xcb_window_t) session->root, XCB_ATOM_RESOURCE_MANAGER,
+                                         XCB_ATOM_STRING, (uint32_t) (resources.size() / 4),
+                                         RESOURCE_MANAGER_MAX_LENGTH_CARD32))), nullptr), free);
+        if (!reply)
+            throw runtime_error("unable to read RESOURCE_MANAGER");
+        if (reply->type == XCB_NONE)
+            break;
+        if (reply->type != XCB_ATOM_STRING || reply->format != 8)
+            throw runtime_error("unexpected RESOURCE_MANAGER type " + to_string(reply->type) + " format " +
+                                to_string(reply->format) + ", expected STRING format 8");
+        resources.append((const char *) xcb_get_property_value(reply.get()),
+                         (size_t) xcb_get_property_value_length(reply.get()));
+        bytesAfter = reply->bytes_after;
+    } while (bytesAfter);
+
+    // nothing to do
+    const string merged = mergeXftDpi(resources, dpi);
+    if (merged == resources)
+        return false;
+
+    traffic.sent(xcb_change_property(conn, XCB_PROP_MODE_REPLACE, (xcb_window_t) session->root,
+                                     XCB_ATOM_RESOURCE_MANAGER, XCB_ATOM_STRING, 8, (uint32_t) merged.size(),
+                                     merged.data()));
+    xcb_flush(conn);
+    return true;
+}
@@ -16,9 +16,22 @@
 #ifndef XLAYOUTDISPLAY_XRDBUTIL_H
 #define XLAYOUTDISPLAY_XRDBUTIL_H
 
+#include "Session.h"
+
+#include <memory>
 #include <string>
 
 // render an xrdb command to set "Xft.dpi"
 const std::string renderXrdbCmd(const long &dpi);
 
+// resource manager contents with "Xft.dpi" replaced in place or appended
+const std::string mergeXftDpi(const std::string &resources, const long &dpi);
+
+// set "Xft.dpi" in the root window's RESOURCE_MANAGER property, as per xrdb -merge without preprocessing
+// the property is written with a single request, only when it changes
+// returns true if the property was written
+// throws runtime_error:
+//   RESOURCE_MANAGER could not be read or is not a STRING of format 8
+bool applyXftDpi(const std::shared_ptr<Session> &session, const long &dpi);
+
 #endif //XLAYOUTDISPLAY_XRDBUTIL_H
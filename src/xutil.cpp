@@ -13,14 +13,18 @@
    See the License for the specific language governing permissions and
    limitations under the License.
 */
+#include "xutil.h"
+
 #include <X11/Xcursor/Xcursor.h>
 
-void resetRootCursor() {
-    Display *dpy = XOpenDisplay(nullptr);
-    int screen = DefaultScreen(dpy);
-    Window root = RootWindow(dpy, screen);
-    Cursor cursor = XcursorLibraryLoadCursor(dpy, "left_ptr");
-    XDefineCursor(dpy, root, cursor);
-    XFreeCursor(dpy, cursor);
-    XCloseDisplay(dpy);
+using namespace std;
+
+void resetRootCursor(const shared_ptr<Session> &session) {
+    const Session fresh(DisplayString(session->dpy));
+
+    // the root window keeps the cursor after it is freed and the connection closed
+    Cursor cursor = XcursorLibraryLoadCursor(fresh.dpy, "left_ptr");
+    XDefineCursor(fresh.dpy, fresh.root, cursor);
+    XFreeCursor(fresh.dpy, cursor);
+    XSync(fresh.dpy, False);
 }
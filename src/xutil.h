@@ -16,8 +16,16 @@
 #ifndef XLAYOUTDISPLAY_XUTIL_H
 #define XLAYOUTDISPLAY_XUTIL_H
 
+#include "Session.h"
+
+#include <memory>
+
 // reset the cursor to "left_ptr" cursor on the root window
 // takes into account new Xft.dpi as well as user Xcursor theme/size settings
-void resetRootCursor();
+// the cursor is loaded via a new connection to session's display, as Xlib reads the resource database and Xcursor its
+// theme and size only once per connection, before any new Xft.dpi was set
+// throws domain_error:
+//   unable to open display
+void resetRootCursor(const std::shared_ptr<Session> &session);
 
 #endif //XLAYOUTDISPLAY_XUTIL_H
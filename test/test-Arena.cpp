@@ -0,0 +1,62 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Arena.h"
+#include "../src/Pos.h"
+
+using namespace std;
+
+TEST(Arena_make, contiguous) {
+    Arena<Pos> arena(3);
+
+    const shared_ptr<Pos> pos1 = arena.make(1, 2);
+    const shared_ptr<Pos> pos2 = arena.make(3, 4);
+    const shared_ptr<Pos> pos3 = arena.make(5, 6);
+
+    EXPECT_EQ(3, arena.size());
+    EXPECT_EQ(1, pos1->x);
+    EXPECT_EQ(4, pos2->y);
+    EXPECT_EQ(pos1.get() + 1, pos2.get());
+    EXPECT_EQ(pos2.get() + 1, pos3.get());
+}
+
+TEST(Arena_make, full) {
+    Arena<Pos> arena(1);
+
+    arena.make(1, 2);
+
+    EXPECT_THROW(arena.make(3, 4), length_error);
+    EXPECT_EQ(1, arena.size());
+}
+
+TEST(Arena_make, outlivesArena) {
+    shared_ptr<const Pos> pos;
+    weak_ptr<const Pos> other;
+    {
+        Arena<Pos> arena(2);
+        pos = arena.make(1, 2);
+        other = arena.make(3, 4);
+    }
+
+    // any pointer keeps the whole arena
+    EXPECT_FALSE(other.expired());
+    EXPECT_EQ(2, pos->y);
+    EXPECT_EQ(4, other.lock()->y);
+
+    pos.reset();
+    EXPECT_TRUE(other.expired());
+}
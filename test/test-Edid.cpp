@@ -73,3 +73,26 @@ TEST_F(Edid_measurements, zeroVert) {
     EXPECT_EQ(0, edid.maxCmVert());
     EXPECT_EQ(0, edid.dpiForMode(make_shared<Mode>(0, 123, 234, 0)));
 }
+
+TEST_F(Edid_measurements, fingerprint) {
+    const uint64_t fingerprint = Edid(val, EDID_MIN_LENGTH, "fingerprint").fingerprint();
+
+    // outside of the identifiers
+    val[EDID_BYTE_MAX_CM_HORIZ] = 9;
+    EXPECT_EQ(fingerprint, Edid(val, EDID_MIN_LENGTH, "fingerprint").fingerprint());
+
+    // serial number
+    val[EDID_BYTE_ID_END - 1] = 9;
+    EXPECT_NE(fingerprint, Edid(val, EDID_MIN_LENGTH, "fingerprint").fingerprint());
+}
+
+TEST(Edid_view, shared) {
+    shared_ptr<unsigned char> data(new unsigned char[EDID_MIN_LENGTH](), default_delete<unsigned char[]>());
+    data.get()[EDID_BYTE_MAX_CM_HORIZ] = 5;
+
+    const Edid edid(data, EDID_MIN_LENGTH, "shared");
+    data.get()[EDID_BYTE_MAX_CM_HORIZ] = 6;
+    data.reset();
+
+    EXPECT_EQ(6, edid.maxCmHoriz());
+}
@@ -0,0 +1,612 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "test-FakeX.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+using namespace std;
+
+#define ROOT 0x100
+#define COLORMAP 0x20
+#define VISUAL 0x21
+#define TIMESTAMP 1
+
+#define RANDR_OPCODE 140
+#define RANDR_FIRST_EVENT 89
+#define RANDR_FIRST_ERROR 147
+#define RANDR_BAD_OUTPUT (RANDR_FIRST_ERROR + 0)
+#define RANDR_BAD_CRTC (RANDR_FIRST_ERROR + 1)
+#define RANDR_BAD_MODE (RANDR_FIRST_ERROR + 2)
+
+#define BAD_REQUEST 1
+#define BAD_VALUE 2
+#define BAD_WINDOW 3
+#define BAD_ATOM 5
+#define BAD_MATCH 8
+#define BAD_LENGTH 16
+
+// 16.16 fixed point
+#define FIXED_ONE 65536
+
+static const char *PREDEFINED_ATOMS[] = {
+        "PRIMARY", "SECONDARY", "ARC", "ATOM", "BITMAP", "CARDINAL", "COLORMAP", "CURSOR", "CUT_BUFFER0", "CUT_BUFFER1",
+        "CUT_BUFFER2", "CUT_BUFFER3", "CUT_BUFFER4", "CUT_BUFFER5", "CUT_BUFFER6", "CUT_BUFFER7", "DRAWABLE", "FONT",
+        "INTEGER", "PIXMAP", "POINT", "RECTANGLE", "RESOURCE_MANAGER", "RGB_COLOR_MAP", "RGB_BEST_MAP", "RGB_BLUE_MAP",
+        "RGB_DEFAULT_MAP", "RGB_GRAY_MAP", "RGB_GREEN_MAP", "RGB_RED_MAP", "STRING", "VISUALID", "WINDOW",
+        "WM_COMMAND", "WM_HINTS", "WM_CLIENT_MACHINE", "WM_ICON_NAME", "WM_ICON_SIZE", "WM_NAME", "WM_NORMAL_HINTS",
+        "WM_SIZE_HINTS", "WM_ZOOM_HINTS", "MIN_SPACE", "NORM_SPACE", "MAX_SPACE", "END_SPACE", "SUPERSCRIPT_X",
+        "SUPERSCRIPT_Y", "SUBSCRIPT_X", "SUBSCRIPT_Y", "UNDERLINE_POSITION", "UNDERLINE_THICKNESS", "STRIKEOUT_ASCENT",
+        "STRIKEOUT_DESCENT", "ITALIC_ANGLE", "X_HEIGHT", "QUAD_WIDTH", "WEIGHT", "POINT_SIZE", "RESOLUTION",
+        "COPYRIGHT", "NOTICE", "FONT_NAME", "FAMILY_NAME", "FULL_NAME", "CAP_HEIGHT", "WM_CLASS", "WM_TRANSIENT_FOR",
+};
+
+namespace {
+
+// little endian, as only such clients are served
+class Bytes {
+public:
+    Bytes &card8(const uint32_t &value) {
+        data.push_back((uint8_t) value);
+        return *this;
+    }
+
+    Bytes &card16(const uint32_t &value) { return card8(value).card8(value >> 8); }
+
+    Bytes &card32(const uint32_t &value) { return card16(value).card16(value >> 16); }
+
+    Bytes &pad(const size_t &n) {
+        data.insert(data.end(), n, 0);
+        return *this;
+    }
+
+    Bytes &text(const string &value) {
+        data.insert(data.end(), value.begin(), value.end());
+        return *this;
+    }
+
+    Bytes &align() { return pad((4 - data.size() % 4) % 4); }
+
+    vector<uint8_t> data;
+};
+
+// a request's fields, at byte offsets
+class Request {
+public:
+    explicit Request(const vector<uint8_t> &bytes) : bytes(bytes) {}
+
+    uint8_t card8(const size_t &offset) const {
+        if (offset >= bytes.size())
+            throw length_error("request too short");
+        return bytes[offset];
+    }
+
+    uint16_t card16(const size_t &offset) const {
+        return (uint16_t) (card8(offset) | card8(offset + 1) << 8);
+    }
+
+    uint32_t card32(const size_t &offset) const {
+        return (uint32_t) card16(offset) | (uint32_t) card16(offset + 2) << 16;
+    }
+
+    const string text(const size_t &offset, const size_t &length) const {
+        if (offset + length > bytes.size())
+            throw length_error("request too short");
+        return string(bytes.begin() + (long) offset, bytes.begin() + (long) (offset + length));
+    }
+
+    vector<uint32_t> list(const size_t &offset) const {
+        vector<uint32_t> values;
+        for (size_t i = offset; i + 4 <= bytes.size(); i += 4)
+            values.push_back(card32(i));
+        return values;
+    }
+
+    const vector<uint8_t> &bytes;
+};
+
+Bytes replyHeader(const uint8_t &data, const uint16_t &sequence) {
+    Bytes reply;
+    reply.card8(1).card8(data).card16(sequence).card32(0);
+    return reply;
+}
+
+// at least 32 bytes with the length of the remainder in words
+vector<uint8_t> finish(Bytes &reply) {
+    reply.align();
+    if (reply.data.size() < 32)
+        reply.pad(32 - reply.data.size());
+    const uint32_t length = (uint32_t) (reply.data.size() - 32) / 4;
+    for (size_t i = 0; i < 4; i++)
+        reply.data[4 + i] = (uint8_t) (length >> (8 * i));
+    return reply.data;
+}
+
+vector<uint8_t> error(const uint8_t &code, const uint16_t &sequence, const uint32_t &value, const Request &request) {
+    Bytes error;
+    error.card8(0).card8(code).card16(sequence).card32(value).card16(request.card8(1)).card8(request.card8(0)).pad(21);
+    return error.data;
+}
+
+// as per GetProperty, which RandR's GetOutputProperty replies to in the same form
+vector<uint8_t> propertyReply(const map<uint32_t, FakeX::Property> &properties, const uint32_t &property,
+                              const uint32_t &type, const uint32_t &offset, const uint32_t &length,
+                              const uint16_t &sequence, const Request &request) {
+    const auto found = properties.find(property);
+    if (found == properties.end()) {
+        Bytes reply = replyHeader(0, sequence);
+        reply.card32(0).card32(0).card32(0).pad(12);
+        return finish(reply);
+    }
+    const FakeX::Property &value = found->second;
+    Bytes reply = replyHeader(value.format, sequence);
+    if (type != 0 && type != value.type) {
+        reply.card32(value.type).card32((uint32_t) value.data.size()).card32(0).pad(12);
+        return finish(reply);
+    }
+    const size_t start = 4 * (size_t) offset;
+    if (start > value.data.size())
+        return error(BAD_VALUE, sequence, offset, request);
+    const size_t n = min(value.data.size() - start, 4 * (size_t) length);
+    reply.card32(value.type).card32((uint32_t) (value.data.size() - start - n)).card32(
+            (uint32_t) (n / (value.format / 8))).pad(12).text(value.data.substr(start, n));
+    return finish(reply);
+}
+
+bool readFully(const int &fd, uint8_t *data, size_t length) {
+    while (length) {
+        const ssize_t n = read(fd, data, length);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        length -= (size_t) n;
+    }
+    return true;
+}
+
+bool writeFully(const int &fd, const vector<uint8_t> &data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += (size_t) n;
+    }
+    return true;
+}
+
+}
+
+FakeX::FakeX(const State &state) : current(state) {
+    for (size_t i = 0; i < sizeof(PREDEFINED_ATOMS) / sizeof(PREDEFINED_ATOMS[0]); i++) {
+        atoms[PREDEFINED_ATOMS[i]] = (uint32_t) i + 1;
+        atomNames[(uint32_t) i + 1] = PREDEFINED_ATOMS[i];
+    }
+
+    // the first free display number, in the abstract namespace that xcb tries first
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        throw system_error(errno, generic_category(), "unable to create socket");
+    for (int display = 1000 + getpid() % 30000;; display++) {
+        const string path = "/tmp/.X11-unix/X" + to_string(display);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path + 1, path.data(), path.size());
+        const socklen_t length = (socklen_t) (offsetof(sockaddr_un, sun_path) + 1 + path.size());
+        if (bind(listenFd, (const sockaddr *) &address, length) == 0) {
+            name = ":" + to_string(display);
+            break;
+        }
+        if (errno != EADDRINUSE) {
+            close(listenFd);
+            throw system_error(errno, generic_category(), "unable to bind " + path);
+        }
+    }
+    if (listen(listenFd, 8) != 0) {
+        close(listenFd);
+        throw system_error(errno, generic_category(), "unable to listen on " + name);
+    }
+    acceptor = thread(&FakeX::accept, this);
+}
+
+FakeX::~FakeX() {
+    shutdown(listenFd, SHUT_RDWR);
+    acceptor.join();
+    close(listenFd);
+    {
+        lock_guard<std::mutex> lock(mutex);
+        for (const auto &fd : fds)
+            shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &server : servers)
+        server.join();
+    for (const auto &fd : fds)
+        close(fd);
+}
+
+uint32_t FakeX::atom(const string &atomName) {
+    lock_guard<std::mutex> lock(mutex);
+    const auto found = atoms.find(atomName);
+    if (found != atoms.end())
+        return found->second;
+    const uint32_t created = (uint32_t) atomNames.rbegin()->first + 1;
+    atoms[atomName] = created;
+    atomNames[created] = atomName;
+    return created;
+}
+
+void FakeX::update(const function<void(State &)> &change) {
+    lock_guard<std::mutex> lock(mutex);
+    change(current);
+}
+
+FakeX::State FakeX::state() const {
+    lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+size_t FakeX::requests() const {
+    lock_guard<std::mutex> lock(mutex);
+    return received;
+}
+
+void FakeX::disconnectAt(const uint16_t &sequence) {
+    lock_guard<std::mutex> lock(mutex);
+    disconnectSequence = sequence;
+}
+
+void FakeX::accept() {
+    for (;;) {
+        const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        lock_guard<std::mutex> lock(mutex);
+        fds.push_back(fd);
+        servers.emplace_back(&FakeX::serve, this, fd);
+    }
+}
+
+void FakeX::serve(const int &fd) {
+
+    // connection setup, ignoring authorisation
+    uint8_t prefix[12];
+    if (!readFully(fd, prefix, sizeof(prefix)) || prefix[0] != 'l')
+        return;
+    const size_t authName = (size_t) (prefix[6] | prefix[7] << 8);
+    const size_t authData = (size_t) (prefix[8] | prefix[9] << 8);
+    vector<uint8_t> auth((authName + 3) / 4 * 4 + (authData + 3) / 4 * 4);
+    if (!readFully(fd, auth.data(), auth.size()))
+        return;
+
+    const string vendor = "xlayoutdisplay FakeX";
+    const State state = this->state();
+    Bytes setup;
+    setup.card8(1).pad(1).card16(11).card16(0).card16(0);
+    setup.card32(1).card32(0x00200000).card32(0x001fffff).card32(256).card16((uint32_t) vendor.size()).card16(65535);
+    setup.card8(1).card8(2).card8(0).card8(0).card8(32).card8(32).card8(8).card8(255).pad(4);
+    setup.text(vendor).align();
+    setup.card8(1).card8(1).card8(32).pad(5);
+    setup.card8(24).card8(32).card8(32).pad(5);
+    setup.card32(ROOT).card32(COLORMAP).card32(0xffffff).card32(0).card32(0);
+    setup.card16(state.width).card16(state.height).card16(state.mmWidth).card16(state.mmHeight);
+    setup.card16(1).card16(1).card32(VISUAL).card8(0).card8(0).card8(24).card8(1);
+    setup.card8(24).pad(1).card16(1).pad(4);
+    setup.card32(VISUAL).card8(4).card8(8).card16(256).card32(0xff0000).card32(0xff00).card32(0xff).pad(4);
+    const uint32_t length = (uint32_t) (setup.data.size() - 8) / 4;
+    setup.data[6] = (uint8_t) length;
+    setup.data[7] = (uint8_t) (length >> 8);
+    if (!writeFully(fd, setup.data))
+        return;
+
+    // requests in order, numbered as the client does
+    for (uint16_t sequence = 1;; sequence++) {
+        vector<uint8_t> request(4);
+        if (!readFully(fd, request.data(), 4))
+            return;
+        const size_t length = (size_t) (request[2] | request[3] << 8) * 4;
+        if (length < 4)
+            return;
+        request.resize(length);
+        if (!readFully(fd, request.data() + 4, length - 4))
+            return;
+        {
+            lock_guard<std::mutex> lock(mutex);
+            if (sequence == disconnectSequence) {
+                shutdown(fd, SHUT_RDWR);
+                return;
+            }
+        }
+        const vector<uint8_t> response = handle(request, sequence);
+        if (!response.empty() && !writeFully(fd, response))
+            return;
+    }
+}
+
+vector<uint8_t> FakeX::handle(const vector<uint8_t> &bytes, const uint16_t &sequence) {
+    lock_guard<std::mutex> lock(mutex);
+    received++;
+    const Request request(bytes);
+    try {
+        switch (request.card8(0)) {
+            case 14: { // GetGeometry
+                Bytes reply = replyHeader(24, sequence);
+                reply.card32(ROOT).card16(0).card16(0).card16(current.width).card16(current.height).card16(0);
+                return finish(reply);
+            }
+            case 16: { // InternAtom
+                const string atomName = request.text(8, request.card16(4));
+                const auto found = atoms.find(atomName);
+                uint32_t atom = found == atoms.end() ? 0 : found->second;
+                if (!atom && !request.card8(1)) {
+                    atom = atomNames.rbegin()->first + 1;
+                    atoms[atomName] = atom;
+                    atomNames[atom] = atomName;
+                }
+                Bytes reply = replyHeader(0, sequence);
+                reply.card32(atom);
+                return finish(reply);
+            }
+            case 17: { // GetAtomName
+                const auto found = atomNames.find(request.card32(4));
+                if (found == atomNames.end())
+                    return error(BAD_ATOM, sequence, request.card32(4), request);
+                Bytes reply = replyHeader(0, sequence);
+                reply.card16((uint32_t) found->second.size()).pad(22).text(found->second);
+                return finish(reply);
+            }
+            case 18: { // ChangeProperty
+                if (request.card32(4) != ROOT)
+                    return error(BAD_WINDOW, sequence, request.card32(4), request);
+                const uint8_t format = request.card8(16);
+                if (format != 8 && format != 16 && format != 32)
+                    return error(BAD_VALUE, sequence, format, request);
+                const string data = request.text(24, request.card32(20) * (format / 8));
+                Property &property = current.rootProperties[request.card32(8)];
+                if (request.card8(1) == 0 || property.data.empty())
+                    property = Property{request.card32(12), format, data};
+                else if (property.type != request.card32(12) || property.format != format)
+                    return error(BAD_MATCH, sequence, 0, request);
+                else if (request.card8(1) == 1)
+                    property.data = data + property.data;
+                else
+                    property.data += data;
+                return {};
+            }
+            case 19: // DeleteProperty
+                current.rootProperties.erase(request.card32(8));
+                return {};
+            case 20: // GetProperty
+                if (request.card32(4) != ROOT)
+                    return error(BAD_WINDOW, sequence, request.card32(4), request);
+                return propertyReply(current.rootProperties, request.card32(8), request.card32(12),
+                                     request.card32(16), request.card32(20), sequence, request);
+            case 43: { // GetInputFocus
+                Bytes reply = replyHeader(1, sequence);
+                reply.card32(1);
+                return finish(reply);
+            }
+            case 98: { // QueryExtension
+                const bool randr = request.text(8, request.card16(4)) == "RANDR";
+                Bytes reply = replyHeader(0, sequence);
+                reply.card8(randr).card8(randr ? RANDR_OPCODE : 0).card8(randr ? RANDR_FIRST_EVENT : 0)
+                        .card8(randr ? RANDR_FIRST_ERROR : 0);
+                return finish(reply);
+            }
+            case RANDR_OPCODE:
+                return handleRandr(bytes, sequence);
+            case 2: // ChangeWindowAttributes
+            case 36: // GrabServer
+            case 37: // UngrabServer
+            case 45: // OpenFont
+            case 46: // CloseFont
+            case 53: // CreatePixmap
+            case 54: // FreePixmap
+            case 55: // CreateGC
+            case 56: // ChangeGC
+            case 60: // FreeGC
+            case 72: // PutImage
+            case 93: // CreateCursor
+            case 94: // CreateGlyphCursor
+            case 95: // FreeCursor
+            case 127: // NoOperation
+                return {};
+            default:
+                return error(BAD_REQUEST, sequence, 0, request);
+        }
+    } catch (const length_error &) {
+        return error(BAD_LENGTH, sequence, 0, request);
+    }
+}
+
+vector<uint8_t> FakeX::handleRandr(const vector<uint8_t> &bytes, const uint16_t &sequence) {
+    const Request request(bytes);
+    switch (request.card8(1)) {
+        case 0: { // QueryVersion
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(1).card32(6);
+            return finish(reply);
+        }
+        case 4: // SelectInput
+            return {};
+        case 6: { // GetScreenSizeRange
+            Bytes reply = replyHeader(0, sequence);
+            reply.card16(current.minWidth).card16(current.minHeight).card16(current.maxWidth).card16(current.maxHeight);
+            return finish(reply);
+        }
+        case 7: { // SetScreenSize
+            const uint16_t width = request.card16(8);
+            const uint16_t height = request.card16(10);
+            if (width < current.minWidth || width > current.maxWidth)
+                return error(BAD_VALUE, sequence, width, request);
+            if (height < current.minHeight || height > current.maxHeight)
+                return error(BAD_VALUE, sequence, height, request);
+            current.width = width;
+            current.height = height;
+            current.mmWidth = request.card32(12);
+            current.mmHeight = request.card32(16);
+            return {};
+        }
+        case 8: // GetScreenResources
+        case 25: { // GetScreenResourcesCurrent
+            string names;
+            for (const auto &mode : current.modes)
+                names += to_string(mode.width) + "x" + to_string(mode.height);
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(TIMESTAMP).card32(TIMESTAMP).card16((uint32_t) current.crtcs.size())
+                    .card16((uint32_t) current.outputs.size()).card16((uint32_t) current.modes.size())
+                    .card16((uint32_t) names.size()).pad(8);
+            for (const auto &crtc : current.crtcs)
+                reply.card32(crtc.id);
+            for (const auto &output : current.outputs)
+                reply.card32(output.id);
+            for (const auto &mode : current.modes) {
+                const string modeName = to_string(mode.width) + "x" + to_string(mode.height);
+                reply.card32(mode.id).card16(mode.width).card16(mode.height).card32(mode.dotClock)
+                        .card16(mode.width).card16(mode.width).card16(mode.hTotal).card16(0)
+                        .card16(mode.height).card16(mode.height).card16(mode.vTotal)
+                        .card16((uint32_t) modeName.size()).card32(0);
+            }
+            reply.text(names);
+            return finish(reply);
+        }
+        case 9: { // GetOutputInfo
+            const auto output = find_if(current.outputs.begin(), current.outputs.end(),
+                                        [&request](const Output &o) { return o.id == request.card32(4); });
+            if (output == current.outputs.end())
+                return error(RANDR_BAD_OUTPUT, sequence, request.card32(4), request);
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(TIMESTAMP).card32(output->crtc).card32(output->mmWidth).card32(output->mmHeight)
+                    .card8(output->connection).card8(0).card16((uint32_t) output->crtcs.size())
+                    .card16((uint32_t) output->modes.size()).card16(output->npreferred)
+                    .card16((uint32_t) output->clones.size()).card16((uint32_t) output->name.size());
+            for (const auto &crtc : output->crtcs)
+                reply.card32(crtc);
+            for (const auto &mode : output->modes)
+                reply.card32(mode);
+            for (const auto &clone : output->clones)
+                reply.card32(clone);
+            reply.text(output->name);
+            return finish(reply);
+        }
+        case 10: { // ListOutputProperties
+            const auto output = find_if(current.outputs.begin(), current.outputs.end(),
+                                        [&request](const Output &o) { return o.id == request.card32(4); });
+            if (output == current.outputs.end())
+                return error(RANDR_BAD_OUTPUT, sequence, request.card32(4), request);
+            Bytes reply = replyHeader(0, sequence);
+            reply.card16((uint32_t) output->properties.size()).pad(22);
+            for (const auto &property : output->properties)
+                reply.card32(property.first);
+            return finish(reply);
+        }
+        case 15: { // GetOutputProperty
+            const auto output = find_if(current.outputs.begin(), current.outputs.end(),
+                                        [&request](const Output &o) { return o.id == request.card32(4); });
+            if (output == current.outputs.end())
+                return error(RANDR_BAD_OUTPUT, sequence, request.card32(4), request);
+            return propertyReply(output->properties, request.card32(8), request.card32(12), request.card32(16),
+                                 request.card32(20), sequence, request);
+        }
+        case 20: { // GetCrtcInfo
+            const auto crtc = find_if(current.crtcs.begin(), current.crtcs.end(),
+                                      [&request](const Crtc &c) { return c.id == request.card32(4); });
+            if (crtc == current.crtcs.end())
+                return error(RANDR_BAD_CRTC, sequence, request.card32(4), request);
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(TIMESTAMP).card16((uint16_t) crtc->x).card16((uint16_t) crtc->y).card16(crtc->width)
+                    .card16(crtc->height).card32(crtc->mode).card16(1).card16(0x3f)
+                    .card16((uint32_t) crtc->outputs.size()).card16((uint32_t) crtc->possible.size());
+            for (const auto &output : crtc->outputs)
+                reply.card32(output);
+            for (const auto &possible : crtc->possible)
+                reply.card32(possible);
+            return finish(reply);
+        }
+        case 21: { // SetCrtcConfig
+            const auto crtc = find_if(current.crtcs.begin(), current.crtcs.end(),
+                                      [&request](const Crtc &c) { return c.id == request.card32(4); });
+            if (crtc == current.crtcs.end())
+                return error(RANDR_BAD_CRTC, sequence, request.card32(4), request);
+            const uint32_t modeId = request.card32(20);
+            const vector<uint32_t> outputIds = request.list(28);
+            const auto mode = find_if(current.modes.begin(), current.modes.end(),
+                                      [&modeId](const Mode &m) { return m.id == modeId; });
+            if (modeId && mode == current.modes.end())
+                return error(RANDR_BAD_MODE, sequence, modeId, request);
+            if (!modeId != outputIds.empty())
+                return error(BAD_MATCH, sequence, 0, request);
+
+            // outputs must be able to use the CRTC and not be using another
+            for (const auto &id : outputIds) {
+                const auto output = find_if(current.outputs.begin(), current.outputs.end(),
+                                            [&id](const Output &o) { return o.id == id; });
+                if (output == current.outputs.end())
+                    return error(RANDR_BAD_OUTPUT, sequence, id, request);
+                if (find(output->crtcs.begin(), output->crtcs.end(), crtc->id) == output->crtcs.end() ||
+                    (output->crtc && output->crtc != crtc->id))
+                    return error(BAD_MATCH, sequence, id, request);
+            }
+
+            for (auto &output : current.outputs)
+                if (output.crtc == crtc->id)
+                    output.crtc = 0;
+            for (auto &output : current.outputs)
+                if (find(outputIds.begin(), outputIds.end(), output.id) != outputIds.end())
+                    output.crtc = crtc->id;
+            const pair<int32_t, int32_t> scale = transforms.count(crtc->id) ? transforms[crtc->id]
+                                                                             : make_pair(FIXED_ONE, FIXED_ONE);
+            crtc->x = (int16_t) request.card16(16);
+            crtc->y = (int16_t) request.card16(18);
+            crtc->mode = modeId;
+            crtc->width = modeId ? (uint16_t) lround((double) mode->width * scale.first / FIXED_ONE) : 0;
+            crtc->height = modeId ? (uint16_t) lround((double) mode->height * scale.second / FIXED_ONE) : 0;
+            crtc->outputs = outputIds;
+
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(TIMESTAMP);
+            return finish(reply);
+        }
+        case 26: // SetCrtcTransform
+            transforms[request.card32(4)] = make_pair((int32_t) request.card32(8), (int32_t) request.card32(24));
+            return {};
+        case 30: // SetOutputPrimary
+            current.primary = request.card32(8);
+            return {};
+        case 31: { // GetOutputPrimary
+            Bytes reply = replyHeader(0, sequence);
+            reply.card32(current.primary);
+            return finish(reply);
+        }
+        default:
+            return error(BAD_REQUEST, sequence, 0, request);
+    }
+}
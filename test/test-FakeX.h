@@ -0,0 +1,143 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#ifndef XLAYOUTDISPLAY_TEST_FAKEX_H
+#define XLAYOUTDISPLAY_TEST_FAKEX_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// an X server with RandR running in this process, for tests that talk to X via Xlib and xcb exactly as they would to
+// a real server
+// it listens on the abstract unix socket for display(), serving each connection on a thread of its own from state
+// only the requests made by xlayoutdisplay and by Xlib when connecting are understood; others fail with BadRequest
+class FakeX {
+public:
+    struct Property {
+        uint32_t type;
+        uint8_t format;
+        std::string data;
+    };
+
+    struct Mode {
+        uint32_t id;
+        uint16_t width;
+        uint16_t height;
+        uint32_t dotClock;
+        uint16_t hTotal;
+        uint16_t vTotal;
+    };
+
+    struct Crtc {
+        uint32_t id;
+        int16_t x;
+        int16_t y;
+        uint16_t width;
+        uint16_t height;
+        uint32_t mode;
+        std::vector<uint32_t> outputs;
+        std::vector<uint32_t> possible;
+    };
+
+    struct Output {
+        uint32_t id;
+        std::string name;
+        uint8_t connection;
+        uint32_t crtc;
+        uint32_t mmWidth;
+        uint32_t mmHeight;
+        uint16_t npreferred;
+        std::vector<uint32_t> crtcs;
+        std::vector<uint32_t> clones;
+        std::vector<uint32_t> modes;
+        std::map<uint32_t, Property> properties;
+    };
+
+    struct State {
+        uint16_t width = 1920;
+        uint16_t height = 1080;
+        uint32_t mmWidth = 508;
+        uint32_t mmHeight = 286;
+        uint16_t minWidth = 8;
+        uint16_t minHeight = 8;
+        uint16_t maxWidth = 16384;
+        uint16_t maxHeight = 16384;
+        uint32_t primary = 0;
+        std::vector<Mode> modes;
+        std::vector<Crtc> crtcs;
+        std::vector<Output> outputs;
+        std::map<uint32_t, Property> rootProperties;
+    };
+
+    // throws system_error:
+    //   unable to listen
+    explicit FakeX(const State &state);
+
+    FakeX(const FakeX &) = delete;
+
+    FakeX &operator=(const FakeX &) = delete;
+
+    // disconnects all clients
+    virtual ~FakeX();
+
+    // name for XOpenDisplay
+    const std::string &display() const { return name; }
+
+    // the atom for name, created when new
+    uint32_t atom(const std::string &atomName);
+
+    // change the state between requests
+    void update(const std::function<void(State &)> &change);
+
+    // a copy of the current state
+    State state() const;
+
+    // requests received from all clients
+    size_t requests() const;
+
+    // close each connection upon its sequence'th request rather than answering it, as a server that goes away does
+    void disconnectAt(const uint16_t &sequence);
+
+private:
+    void accept();
+
+    void serve(const int &fd);
+
+    // the reply, error or nothing for request, along with any changes to state
+    std::vector<uint8_t> handle(const std::vector<uint8_t> &request, const uint16_t &sequence);
+
+    std::vector<uint8_t> handleRandr(const std::vector<uint8_t> &request, const uint16_t &sequence);
+
+    mutable std::mutex mutex;
+    State current;
+    std::map<std::string, uint32_t> atoms;
+    std::map<uint32_t, std::string> atomNames;
+    std::map<uint32_t, std::pair<int32_t, int32_t>> transforms;
+    size_t received = 0;
+    uint16_t disconnectSequence = 0;
+
+    std::string name;
+    int listenFd = -1;
+    std::vector<int> fds;
+    std::thread acceptor;
+    std::vector<std::thread> servers;
+};
+
+#endif //XLAYOUTDISPLAY_TEST_FAKEX_H
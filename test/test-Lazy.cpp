@@ -0,0 +1,95 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Lazy.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST(Lazy_test, empty) {
+    const Lazy<const string> lazy;
+
+    EXPECT_TRUE(lazy.loaded());
+    EXPECT_FALSE(lazy);
+}
+
+TEST(Lazy_test, value) {
+    const shared_ptr<string> value = make_shared<string>("value");
+    const Lazy<const string> lazy(value);
+
+    EXPECT_TRUE(lazy.loaded());
+    EXPECT_TRUE(lazy);
+    EXPECT_EQ(5, lazy->size());
+    EXPECT_EQ(value, lazy.get());
+}
+
+TEST(Lazy_test, loadOnce) {
+    vector<string> calls;
+    const Lazy<const string> lazy([&calls]() { calls.emplace_back("request"); },
+                                  [&calls]() {
+                                      calls.emplace_back("load");
+                                      return make_shared<string>("loaded");
+                                  });
+    EXPECT_FALSE(lazy.loaded());
+    EXPECT_TRUE(calls.empty());
+
+    EXPECT_EQ("loaded", *lazy);
+    EXPECT_EQ("loaded", *lazy);
+    EXPECT_TRUE(lazy.loaded());
+    EXPECT_EQ(vector<string>({"request", "load"}), calls);
+}
+
+TEST(Lazy_test, requestBeforeLoad) {
+    vector<string> calls;
+    const Lazy<const string> lazy1([&calls]() { calls.emplace_back("request1"); },
+                                   [&calls]() {
+                                       calls.emplace_back("load1");
+                                       return shared_ptr<string>();
+                                   });
+    const Lazy<const string> lazy2([&calls]() { calls.emplace_back("request2"); },
+                                   [&calls]() {
+                                       calls.emplace_back("load2");
+                                       return make_shared<string>("loaded2");
+                                   });
+
+    lazy1.request();
+    lazy2.request();
+    lazy1.request();
+    EXPECT_FALSE(lazy1);
+    EXPECT_TRUE(lazy2);
+    EXPECT_FALSE(lazy1);
+
+    EXPECT_EQ(vector<string>({"request1", "request2", "load1", "load2"}), calls);
+}
+
+TEST(Lazy_test, loadThrows) {
+    vector<string> calls;
+    const Lazy<const string> lazy([&calls]() { calls.emplace_back("request"); },
+                                  [&calls]() -> shared_ptr<string> {
+                                      calls.emplace_back("load");
+                                      throw runtime_error("unable to load");
+                                  });
+
+    EXPECT_THROW(lazy.get(), runtime_error);
+    EXPECT_TRUE(lazy.loaded());
+    EXPECT_THROW(lazy.get(), runtime_error);
+    EXPECT_THROW((void) (bool) lazy, runtime_error);
+    EXPECT_EQ(vector<string>({"request", "load"}), calls);
+}
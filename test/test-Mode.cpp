@@ -30,3 +30,13 @@ TEST(Mode_order, height) {
 TEST(Mode_order, refresh) {
     EXPECT_TRUE(Mode(0, 1, 1, 1) < Mode(0, 1, 1, 2));
 }
+
+TEST(Mode_order, key) {
+    EXPECT_EQ(Mode::sortKey(1, 2, 3), Mode(0, 1, 2, 3).key);
+    EXPECT_TRUE(Mode(0, 1, UINT16_MAX, UINT32_MAX).key < Mode(0, 2, 0, 0).key);
+}
+
+TEST(Mode_construct, tooLarge) {
+    EXPECT_THROW(Mode(0, UINT16_MAX + 1, 1, 1), invalid_argument);
+    EXPECT_THROW(Mode(0, 1, UINT16_MAX + 1, 1), invalid_argument);
+}
@@ -0,0 +1,67 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/ModeIndex.h"
+
+using namespace std;
+
+class ModeIndex_test : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        resources.nmode = 3;
+        resources.modes = &modeInfos[0];
+
+        modeInfos[0].id = 10;
+        modeInfos[1].id = 11;
+        modeInfos[1].width = 111;
+        modeInfos[1].height = 112;
+        modeInfos[2].id = 12;
+    }
+
+    XRRScreenResources resources{};
+    XRRModeInfo modeInfos[3]{};
+};
+
+TEST_F(ModeIndex_test, valid) {
+    ModeIndex modeIndex(&resources);
+
+    const shared_ptr<const Mode> mode = modeIndex.mode(11);
+
+    EXPECT_EQ(11, mode->rrMode);
+    EXPECT_EQ(111, mode->width);
+    EXPECT_EQ(112, mode->height);
+}
+
+TEST_F(ModeIndex_test, shared) {
+    ModeIndex modeIndex(&resources);
+
+    const shared_ptr<const Mode> mode = modeIndex.mode(11);
+    EXPECT_EQ(mode, modeIndex.mode(11));
+    EXPECT_EQ(mode, modeIndex.mode(11));
+
+    EXPECT_NE(mode, modeIndex.mode(12));
+}
+
+TEST_F(ModeIndex_test, modeNotPresent) {
+    ModeIndex modeIndex(&resources);
+
+    EXPECT_THROW(modeIndex.mode(13), invalid_argument);
+}
+
+TEST_F(ModeIndex_test, resourcesNotPresent) {
+    EXPECT_THROW(ModeIndex(nullptr), invalid_argument);
+}
@@ -0,0 +1,104 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/ModeTable.h"
+
+using namespace std;
+
+TEST(ModeTable_construct, sortedDescending) {
+    const shared_ptr<const Mode> mode1 = make_shared<Mode>(1, 1, 2, 60);
+    const shared_ptr<const Mode> mode2 = make_shared<Mode>(2, 2, 1, 50);
+    const shared_ptr<const Mode> mode3 = make_shared<Mode>(3, 2, 1, 60);
+    const shared_ptr<const Mode> mode4 = make_shared<Mode>(4, 1, 1, 60);
+
+    const ModeTable modes(list<shared_ptr<const Mode>>{mode1, mode4, mode3, mode2});
+
+    EXPECT_EQ(vector<shared_ptr<const Mode>>({mode3, mode2, mode1, mode4}),
+              vector<shared_ptr<const Mode>>(modes.begin(), modes.end()));
+    EXPECT_EQ(mode3, modes.front());
+    EXPECT_EQ(mode4, modes.back());
+}
+
+TEST(ModeTable_construct, duplicates) {
+    const shared_ptr<const Mode> mode1 = make_shared<Mode>(1, 1, 1, 60);
+    const shared_ptr<const Mode> mode1Again = make_shared<Mode>(1, 1, 1, 60);
+    const shared_ptr<const Mode> mode2 = make_shared<Mode>(2, 1, 1, 60);
+
+    const ModeTable modes(list<shared_ptr<const Mode>>{mode1, mode2, mode1Again, mode1});
+
+    EXPECT_EQ(vector<shared_ptr<const Mode>>({mode1, mode2}),
+              vector<shared_ptr<const Mode>>(modes.begin(), modes.end()));
+}
+
+TEST(ModeTable_construct, lastListedFirst) {
+    const shared_ptr<const Mode> mode1 = make_shared<Mode>(1, 1, 1, 60);
+    const shared_ptr<const Mode> mode2 = make_shared<Mode>(2, 1, 1, 60);
+    const shared_ptr<const Mode> mode3 = make_shared<Mode>(3, 1, 1, 60);
+
+    const ModeTable modes(list<shared_ptr<const Mode>>{mode1, mode2, mode3});
+
+    EXPECT_EQ(vector<shared_ptr<const Mode>>({mode3, mode2, mode1}),
+              vector<shared_ptr<const Mode>>(modes.begin(), modes.end()));
+}
+
+TEST(ModeTable_construct, empty) {
+    const ModeTable modes(list<shared_ptr<const Mode>>{});
+
+    EXPECT_TRUE(modes.empty());
+    EXPECT_EQ(0, modes.size());
+    EXPECT_EQ(modes.end(), modes.begin());
+}
+
+TEST(ModeTable_best, highestRefresh) {
+    const shared_ptr<const Mode> mode1 = make_shared<Mode>(1, 2, 1, 50);
+    const shared_ptr<const Mode> mode2 = make_shared<Mode>(2, 2, 1, 75);
+    const shared_ptr<const Mode> mode3 = make_shared<Mode>(3, 2, 1, 60);
+    const shared_ptr<const Mode> mode4 = make_shared<Mode>(4, 2, 2, 144);
+    const shared_ptr<const Mode> mode5 = make_shared<Mode>(5, 1, 1, 144);
+
+    const ModeTable modes(list<shared_ptr<const Mode>>{mode1, mode2, mode3, mode4, mode5});
+
+    EXPECT_EQ(mode2, modes.best(2, 1));
+    EXPECT_EQ(mode4, modes.best(2, 2));
+    EXPECT_EQ(mode5, modes.best(1, 1));
+}
+
+TEST(ModeTable_best, none) {
+    const ModeTable modes(list<shared_ptr<const Mode>>{make_shared<Mode>(1, 2, 2, 60), make_shared<Mode>(2, 1, 1, 60)});
+
+    EXPECT_EQ(nullptr, modes.best(1, 2));
+    EXPECT_EQ(nullptr, modes.best(3, 3));
+    EXPECT_EQ(nullptr, modes.best(0, 0));
+    EXPECT_EQ(nullptr, ModeTable().best(1, 1));
+}
+
+TEST(ModeTable_nextResolution, skipsRefreshes) {
+    const shared_ptr<const Mode> mode1 = make_shared<Mode>(1, 2, 2, 60);
+    const shared_ptr<const Mode> mode2 = make_shared<Mode>(2, 2, 2, 50);
+    const shared_ptr<const Mode> mode3 = make_shared<Mode>(3, 2, 1, 60);
+    const shared_ptr<const Mode> mode4 = make_shared<Mode>(4, 1, 1, 60);
+    const shared_ptr<const Mode> mode5 = make_shared<Mode>(5, 1, 1, 30);
+
+    const ModeTable modes(list<shared_ptr<const Mode>>{mode1, mode2, mode3, mode4, mode5});
+
+    vector<shared_ptr<const Mode>> resolutions;
+    for (auto it = modes.begin(); it != modes.end(); it = modes.nextResolution(it))
+        resolutions.push_back(*it);
+
+    EXPECT_EQ(vector<shared_ptr<const Mode>>({mode1, mode3, mode4}), resolutions);
+    EXPECT_EQ(modes.end(), modes.nextResolution(modes.end()));
+}
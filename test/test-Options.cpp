@@ -0,0 +1,189 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Options.h"
+
+#include <sstream>
+
+using namespace std;
+
+class Options_test : public ::testing::Test {
+protected:
+    Options options = Options("CLI", "CLI and file", {
+            {"help", 'h', Options::flag, false, "print this help text and exit", nullptr, nullptr},
+            {"timings", 0, Options::text, false, "print the time taken by each phase", "text", nullptr},
+            {"dpi", 'd', Options::number, true, "DPI override", nullptr, nullptr},
+            {"display", 0, Options::texts, true, "X display", nullptr, nullptr},
+            {"order", 'o', Options::texts, true, "order of outputs, repeat as needed", nullptr, nullptr},
+            {"primary", 'p', Options::text, true, "primary output", nullptr, nullptr},
+            {"quiet", 'q', Options::flag, true, "suppress feedback", nullptr, nullptr},
+            {"settle", 0, Options::number, true, "milliseconds without RandR events before laying out again, once a burst of events has passed", nullptr, "250"},
+    });
+
+    void parse(const vector<const char *> &args) {
+        vector<const char *> argv = {"xlayoutdisplay"};
+        argv.insert(argv.end(), args.begin(), args.end());
+        options.parse((int) argv.size(), argv.data());
+    }
+
+    void parseFile(const string &file) {
+        istringstream in(file);
+        options.parse(in);
+    }
+
+    // message thrown parsing args
+    string error(const vector<const char *> &args) {
+        try {
+            parse(args);
+        } catch (const invalid_argument &e) {
+            return e.what();
+        }
+        return string();
+    }
+
+    // message thrown parsing file
+    string fileError(const string &file) {
+        try {
+            parseFile(file);
+        } catch (const invalid_argument &e) {
+            return e.what();
+        }
+        return string();
+    }
+};
+
+TEST_F(Options_test, long) {
+    parse({"--dpi", "-5", "--primary=DP-0", "--order", "--quiet", "--order=HDMI-0", "--quiet"});
+
+    EXPECT_EQ(-5, options.numberValue("dpi"));
+    EXPECT_EQ("DP-0", options.textValue("primary"));
+    EXPECT_EQ(vector<string>({"--quiet", "HDMI-0"}), options.textValues("order"));
+    EXPECT_EQ(1, options.count("quiet"));
+    EXPECT_EQ(0, options.count("help"));
+    EXPECT_EQ(0, options.count("display"));
+    EXPECT_EQ(1, options.count("settle"));
+    EXPECT_EQ(250, options.numberValue("settle"));
+}
+
+TEST_F(Options_test, short) {
+    parse({"-qd96", "-o", "DP-0", "-oHDMI-0", "-p=x"});
+
+    EXPECT_EQ(1, options.count("quiet"));
+    EXPECT_EQ(96, options.numberValue("dpi"));
+    EXPECT_EQ(vector<string>({"DP-0", "HDMI-0"}), options.textValues("order"));
+    EXPECT_EQ("=x", options.textValue("primary"));
+}
+
+TEST_F(Options_test, abbreviated) {
+    parse({"--pri", "DP-0", "--q"});
+
+    EXPECT_EQ("DP-0", options.textValue("primary"));
+    EXPECT_EQ(1, options.count("quiet"));
+    EXPECT_EQ("option '--d=1' is ambiguous and matches '--display', and '--dpi'", error({"--d=1"}));
+}
+
+TEST_F(Options_test, implicit) {
+    parse({"--timings", "--", "json"});
+
+    EXPECT_EQ("text", options.textValue("timings"));
+}
+
+TEST_F(Options_test, implicitFollowed) {
+    parse({"--timings", "json", "ignored"});
+
+    EXPECT_EQ("json", options.textValue("timings"));
+}
+
+TEST_F(Options_test, arguments) {
+    parse({"ignored", "-", "--", "--dpi", "x"});
+
+    EXPECT_EQ(0, options.count("dpi"));
+}
+
+TEST_F(Options_test, errors) {
+    EXPECT_EQ("unrecognised option '--foo=1'", error({"--foo=1"}));
+    EXPECT_EQ("unrecognised option '-qx'", error({"-qx"}));
+    EXPECT_EQ("the required argument for option '--dpi' is missing", error({"-qd"}));
+    EXPECT_EQ("the required argument for option '--primary' is missing", error({"--primary", "-q"}));
+    EXPECT_EQ("the argument ('-qn') for option '--dpi' is invalid", error({"--dpi", "-qn"}));
+    EXPECT_EQ("the argument ('9999999999999999999999') for option '--dpi' is invalid",
+              error({"--dpi=9999999999999999999999"}));
+    EXPECT_EQ("the argument for option '--dpi' is invalid", error({"--dpi", ""}));
+    EXPECT_EQ("the argument for option '--pr' should follow immediately after the equal sign", error({"--pr="}));
+    EXPECT_EQ("the argument for option '--dpi' should follow immediately after the equal sign",
+              error({"--dpi", "--x="}));
+    EXPECT_EQ("option '--quiet' does not take any arguments", error({"--quiet=1"}));
+    EXPECT_EQ("option '--quiet' cannot be specified more than once", error({"-qq"}));
+    EXPECT_EQ("option '--dpi' cannot be specified more than once", error({"--dpi", "1", "-d2"}));
+}
+
+TEST_F(Options_test, file) {
+    parseFile("# comment\n"
+          "  dpi = 96  # comment\r\n"
+          "\n"
+          "quiet=false\n"
+          "order=DP-0\n"
+          "order=HDMI-0\n"
+          "settle=10\n");
+
+    EXPECT_EQ(96, options.numberValue("dpi"));
+    EXPECT_EQ(1, options.count("quiet"));
+    EXPECT_EQ(vector<string>({"DP-0", "HDMI-0"}), options.textValues("order"));
+    EXPECT_EQ(10, options.numberValue("settle"));
+}
+
+TEST_F(Options_test, fileErrors) {
+    EXPECT_EQ("unrecognised option 'help'", fileError("help=1\n"));
+    EXPECT_EQ("unrecognised option 'pri'", fileError("pri=DP-0\n"));
+    EXPECT_EQ("unrecognised option 'x.dpi'", fileError("[x]\ndpi=1\n"));
+    EXPECT_EQ("unrecognised option", fileError("=1\n"));
+    EXPECT_EQ("the options configuration file contains an invalid line 'quiet'", fileError("quiet # comment\n"));
+    EXPECT_EQ("the argument for option 'dpi' is invalid", fileError("dpi=\n"));
+    EXPECT_EQ("option 'primary' cannot be specified more than once", fileError("primary=a\nprimary=b\n"));
+}
+
+TEST_F(Options_test, commandLineFirst) {
+    parse({"--dpi", "1", "--order", "DP-0"});
+    parseFile("dpi=abc\n"
+          "order=HDMI-0\n"
+          "primary=DP-0\n"
+          "settle=10\n");
+
+    EXPECT_EQ(1, options.numberValue("dpi"));
+    EXPECT_EQ(vector<string>({"DP-0"}), options.textValues("order"));
+    EXPECT_EQ("DP-0", options.textValue("primary"));
+    EXPECT_EQ(10, options.numberValue("settle"));
+}
+
+TEST_F(Options_test, help) {
+    ostringstream help;
+    help << options;
+
+    EXPECT_EQ("CLI:\n"
+              "  -h [ --help ]           print this help text and exit\n"
+              "  --timings [=arg(=text)] print the time taken by each phase\n"
+              "\n"
+              "CLI and file:\n"
+              "  -d [ --dpi ] arg        DPI override\n"
+              "  --display arg           X display\n"
+              "  -o [ --order ] arg      order of outputs, repeat as needed\n"
+              "  -p [ --primary ] arg    primary output\n"
+              "  -q [ --quiet ]          suppress feedback\n"
+              "  --settle arg (=250)     milliseconds without RandR events before laying out \n"
+              "                          again, once a burst of events has passed\n",
+              help.str());
+}
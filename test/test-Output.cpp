@@ -69,3 +69,18 @@ TEST_F(Output_test, connectedPreferredNotInModes) {
 TEST_F(Output_test, disconnectedPreferredNotInModes) {
     Output("disconnectedPreferredNotInModes", Output::disconnected, modes, nullptr, modeInexistent, nullptr, edid);
 }
+
+TEST_F(Output_test, resetDesired) {
+    Output output("resetDesired", Output::active, modes, mode1, nullptr, pos, edid);
+    output.desiredActive = true;
+    output.desiredMode = mode2;
+    output.desiredPos = pos;
+    output.desiredCrtc = 3;
+
+    output.resetDesired();
+
+    EXPECT_FALSE(output.desiredActive);
+    EXPECT_FALSE(output.desiredMode);
+    EXPECT_FALSE(output.desiredPos);
+    EXPECT_EQ(0, output.desiredCrtc);
+}
@@ -0,0 +1,85 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/OutputOrder.h"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+static const shared_ptr<Output> output(const string &name, const shared_ptr<const Edid> &edid = nullptr) {
+    return make_shared<Output>(name, Output::disconnected, list<shared_ptr<const Mode>>(), nullptr, nullptr, nullptr,
+                               edid);
+}
+
+static const shared_ptr<const Edid> edid(const unsigned char &serial) {
+    unsigned char data[EDID_MIN_LENGTH] = {};
+    data[EDID_BYTE_ID_START] = serial;
+    return make_shared<Edid>(data, EDID_MIN_LENGTH, "test");
+}
+
+TEST(OutputOrder_rank, names) {
+    const OutputOrder order({"HDMI-0", "dp-1", "hdmi-0"});
+
+    EXPECT_EQ(3, order.size());
+    EXPECT_EQ(0, order.rank(*output("hdmi-0")));
+    EXPECT_EQ(1, order.rank(*output("DP-1")));
+    EXPECT_EQ(3, order.rank(*output("DP-1-1")));
+}
+
+TEST(OutputOrder_rank, globs) {
+    const OutputOrder order({"DP-1-2", "dp-1-*", "HDMI-?", "eDP-[0-9]"});
+
+    EXPECT_EQ(0, order.rank(*output("DP-1-2")));
+    EXPECT_EQ(1, order.rank(*output("DP-1-1")));
+    EXPECT_EQ(2, order.rank(*output("hdmi-0")));
+    EXPECT_EQ(3, order.rank(*output("eDP-1")));
+    EXPECT_EQ(4, order.rank(*output("eDP-1-1")));
+    EXPECT_EQ(4, order.rank(*output("DP-2")));
+}
+
+TEST(OutputOrder_rank, edid) {
+    const shared_ptr<const Edid> edid1 = edid(1);
+    const shared_ptr<const Edid> edid2 = edid(2);
+    stringstream fingerprint2;
+    fingerprint2 << "EDID:" << hex << uppercase << edid2->fingerprint();
+
+    const OutputOrder order({"DP-0", fingerprint2.str(), "DP-*"});
+
+    EXPECT_TRUE(order.matchesEdid());
+    EXPECT_EQ(0, order.rank(*output("DP-0", edid2)));
+    EXPECT_EQ(1, order.rank(*output("DP-1", edid2)));
+    EXPECT_EQ(2, order.rank(*output("DP-1", edid1)));
+    EXPECT_EQ(3, order.rank(*output("HDMI-0")));
+}
+
+TEST(OutputOrder_rank, empty) {
+    const OutputOrder order({});
+
+    EXPECT_TRUE(order.empty());
+    EXPECT_FALSE(order.matchesEdid());
+    EXPECT_EQ(0, order.rank(*output("DP-0")));
+}
+
+TEST(OutputOrder_construct, invalidEdid) {
+    EXPECT_THROW(OutputOrder({"edid:"}), invalid_argument);
+    EXPECT_THROW(OutputOrder({"edid:12345678g"}), invalid_argument);
+    EXPECT_THROW(OutputOrder({"edid: 1234"}), invalid_argument);
+    EXPECT_THROW(OutputOrder({"edid:0123456789abcdef0"}), invalid_argument);
+    EXPECT_NO_THROW(OutputOrder({"edid:0123456789abcdef"}));
+}
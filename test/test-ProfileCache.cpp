@@ -0,0 +1,239 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/ProfileCache.h"
+
+#include <dirent.h>
+
+#include <cstring>
+
+using namespace std;
+
+class ProfileCache_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        memset(edidVal, 1, EDID_MIN_LENGTH);
+        edid = make_shared<Edid>(edidVal, EDID_MIN_LENGTH, "ProfileCache_test");
+
+        output1->desiredActive = true;
+        output1->desiredMode = mode1;
+        output1->desiredPos = make_shared<Pos>(0, 0);
+
+        output2->desiredActive = true;
+        output2->desiredMode = mode2;
+        output2->desiredPos = make_shared<Pos>(10, 0);
+    }
+
+    void TearDown() override {
+        // always try and remove anything from store
+        remove("./cache/profiles");
+        rmdir("./cache");
+    }
+
+    void resetDesired() {
+        for (const auto &output : outputs)
+            output->resetDesired();
+    }
+
+    unsigned char edidVal[EDID_MIN_LENGTH]{};
+    shared_ptr<Edid> edid;
+
+    shared_ptr<Mode> mode1 = make_shared<Mode>(1, 10, 20, 60);
+    shared_ptr<Mode> mode2 = make_shared<Mode>(2, 30, 40, 60);
+    list<shared_ptr<const Mode>> modes = {mode1, mode2};
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    shared_ptr<Output> output3 = make_shared<Output>("Three", Output::disconnected, list<shared_ptr<const Mode>>(),
+                                                     nullptr, nullptr, nullptr, shared_ptr<Edid>());
+    list<shared_ptr<Output>> outputs = {output1, output2, output3};
+
+    ProfileCache profileCache{"./cache/profiles"};
+};
+
+TEST_F(ProfileCache_test, profileKey) {
+    const uint64_t key = ProfileCache::profileKey(outputs);
+
+    EXPECT_EQ(key, ProfileCache::profileKey({output2, output1}));
+    EXPECT_NE(key, ProfileCache::profileKey({output1}));
+
+    shared_ptr<Output> withEdid = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr, edid);
+    EXPECT_NE(key, ProfileCache::profileKey({withEdid, output2}));
+
+    // another monitor of the same model, differing only in serial
+    unsigned char otherVal[EDID_MIN_LENGTH];
+    memcpy(otherVal, edidVal, EDID_MIN_LENGTH);
+    otherVal[12] = 2;
+    const shared_ptr<Edid> other = make_shared<Edid>(otherVal, EDID_MIN_LENGTH, "other");
+    shared_ptr<Output> withOther = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                       other);
+    EXPECT_NE(ProfileCache::profileKey({withEdid, output2}), ProfileCache::profileKey({withOther, output2}));
+
+    // the same monitors swapped between outputs
+    shared_ptr<Output> twoWithEdid = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                         edid);
+    shared_ptr<Output> twoWithOther = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                          other);
+    EXPECT_NE(ProfileCache::profileKey({withEdid, twoWithOther}), ProfileCache::profileKey({withOther, twoWithEdid}));
+}
+
+TEST_F(ProfileCache_test, settingsKey) {
+    const Settings settings(settingsOptions());
+
+    EXPECT_EQ(ProfileCache::settingsKey(settings, false), ProfileCache::settingsKey(settings, false));
+    EXPECT_NE(ProfileCache::settingsKey(settings, false), ProfileCache::settingsKey(settings, true));
+}
+
+TEST_F(ProfileCache_test, missing) {
+    shared_ptr<Output> primary;
+    long dpi = 0;
+
+    EXPECT_FALSE(profileCache.load(1, 2, outputs, &primary, &dpi));
+}
+
+TEST_F(ProfileCache_test, storeLoad) {
+    profileCache.store(1, 2, outputs, output2, 96);
+    resetDesired();
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    ASSERT_TRUE(profileCache.load(1, 2, outputs, &primary, &dpi));
+
+    EXPECT_EQ(output2, primary);
+    EXPECT_EQ(96, dpi);
+    EXPECT_TRUE(output1->desiredActive);
+    EXPECT_EQ(mode1, output1->desiredMode);
+    EXPECT_EQ(0, output1->desiredPos->x);
+    EXPECT_TRUE(output2->desiredActive);
+    EXPECT_EQ(mode2, output2->desiredMode);
+    EXPECT_EQ(10, output2->desiredPos->x);
+    EXPECT_FALSE(output3->desiredActive);
+}
+
+TEST_F(ProfileCache_test, scaled) {
+    output1->desiredScaleFrom = make_pair(30u, 40u);
+    profileCache.store(1, 2, outputs, output2, 96);
+    resetDesired();
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    ASSERT_TRUE(profileCache.load(1, 2, outputs, &primary, &dpi));
+
+    EXPECT_EQ(make_pair(30u, 40u), output1->desiredScaleFrom);
+    EXPECT_EQ(make_pair(0u, 0u), output2->desiredScaleFrom);
+}
+
+TEST_F(ProfileCache_test, settingsChanged) {
+    profileCache.store(1, 2, outputs, output2, 96);
+    resetDesired();
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    EXPECT_FALSE(profileCache.load(1, 3, outputs, &primary, &dpi));
+    EXPECT_FALSE(output1->desiredActive);
+}
+
+TEST_F(ProfileCache_test, replace) {
+    profileCache.store(1, 2, outputs, output2, 96);
+    profileCache.store(5, 6, outputs, output2, 144);
+    profileCache.store(1, 3, outputs, output1, 192);
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    EXPECT_FALSE(profileCache.load(1, 2, outputs, &primary, &dpi));
+    ASSERT_TRUE(profileCache.load(1, 3, outputs, &primary, &dpi));
+    EXPECT_EQ(output1, primary);
+    EXPECT_EQ(192, dpi);
+    ASSERT_TRUE(profileCache.load(5, 6, outputs, &primary, &dpi));
+    EXPECT_EQ(144, dpi);
+}
+
+TEST_F(ProfileCache_test, evictOldest) {
+    for (uint64_t profile = 0; profile <= PROFILE_CACHE_MAX_PROFILES; profile++)
+        profileCache.store(profile, 0, outputs, output1, 96);
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    EXPECT_FALSE(profileCache.load(0, 0, outputs, &primary, &dpi));
+    EXPECT_TRUE(profileCache.load(1, 0, outputs, &primary, &dpi));
+    EXPECT_TRUE(profileCache.load(PROFILE_CACHE_MAX_PROFILES, 0, outputs, &primary, &dpi));
+}
+
+TEST_F(ProfileCache_test, modeByResolution) {
+    profileCache.store(1, 2, outputs, output1, 96);
+
+    shared_ptr<Mode> renumbered = make_shared<Mode>(7, 10, 20, 60);
+    shared_ptr<Output> other1 = make_shared<Output>("One", Output::connected,
+                                                    list<shared_ptr<const Mode>>({renumbered, mode2}),
+                                                    nullptr, nullptr, nullptr, shared_ptr<Edid>());
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    ASSERT_TRUE(profileCache.load(1, 2, {other1, output2}, &primary, &dpi));
+    EXPECT_EQ(renumbered, other1->desiredMode);
+}
+
+TEST_F(ProfileCache_test, noLongerFits) {
+    profileCache.store(1, 2, outputs, output1, 96);
+    resetDesired();
+
+    shared_ptr<Output> other1 = make_shared<Output>("One", Output::connected, list<shared_ptr<const Mode>>({mode2}),
+                                                    nullptr, nullptr, nullptr, shared_ptr<Edid>());
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    EXPECT_FALSE(profileCache.load(1, 2, {other1, output2}, &primary, &dpi));
+    EXPECT_FALSE(profileCache.load(1, 2, {output1}, &primary, &dpi));
+    EXPECT_FALSE(output1->desiredActive);
+    EXPECT_FALSE(output2->desiredActive);
+}
+
+TEST_F(ProfileCache_test, corrupt) {
+    ASSERT_EQ(0, mkdir("./cache", 0755));
+    FILE *file = fopen("./cache/profiles", "w");
+    ASSERT_TRUE(file != nullptr);
+    fputs("not a cache at all, not even close", file);
+    ASSERT_EQ(0, fclose(file));
+
+    shared_ptr<Output> primary;
+    long dpi = 0;
+    EXPECT_FALSE(profileCache.load(1, 2, outputs, &primary, &dpi));
+
+    profileCache.store(1, 2, outputs, output1, 96);
+    EXPECT_TRUE(profileCache.load(1, 2, outputs, &primary, &dpi));
+}
+
+TEST_F(ProfileCache_test, storeLeavesOnlyCache) {
+    ASSERT_EQ(0, mkdir("./cache", 0755));
+    FILE *file = fopen("./cache/profiles.tmp", "w");
+    ASSERT_TRUE(file != nullptr);
+    fputs("someone else's", file);
+    ASSERT_EQ(0, fclose(file));
+
+    profileCache.store(1, 2, outputs, output1, 96);
+    profileCache.store(3, 4, outputs, output1, 96);
+
+    set<string> names;
+    DIR *dir = opendir("./cache");
+    ASSERT_TRUE(dir != nullptr);
+    for (const dirent *entry = readdir(dir); entry; entry = readdir(dir))
+        names.insert(entry->d_name);
+    closedir(dir);
+    EXPECT_EQ(set<string>({".", "..", "profiles", "profiles.tmp"}), names);
+
+    remove("./cache/profiles.tmp");
+}
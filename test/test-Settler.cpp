@@ -0,0 +1,70 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Settler.h"
+
+using namespace std;
+
+class Settler_test : public ::testing::Test {
+protected:
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Settler settler{chrono::milliseconds(100)};
+};
+
+TEST_F(Settler_test, idle) {
+    EXPECT_EQ(-1, settler.timeout(start));
+    EXPECT_EQ(0, settler.pending());
+}
+
+TEST_F(Settler_test, burst) {
+    settler.event(start);
+    EXPECT_EQ(100, settler.timeout(start));
+
+    settler.event(start + chrono::milliseconds(60));
+    settler.event(start + chrono::milliseconds(80));
+    EXPECT_EQ(3, settler.pending());
+    EXPECT_EQ(100, settler.timeout(start + chrono::milliseconds(80)));
+    EXPECT_EQ(50, settler.timeout(start + chrono::milliseconds(130)));
+    EXPECT_EQ(1, settler.timeout(start + chrono::microseconds(179500)));
+    EXPECT_EQ(0, settler.timeout(start + chrono::milliseconds(180)));
+
+    settler.settled();
+    EXPECT_EQ(-1, settler.timeout(start + chrono::milliseconds(180)));
+    EXPECT_EQ(0, settler.pending());
+}
+
+TEST_F(Settler_test, own) {
+    settler.own(10, 20);
+    EXPECT_FALSE(settler.event(start, 10));
+    EXPECT_FALSE(settler.event(start, 19));
+    EXPECT_EQ(-1, settler.timeout(start));
+    EXPECT_EQ(0, settler.pending());
+
+    EXPECT_TRUE(settler.event(start, 20));
+    EXPECT_EQ(1, settler.pending());
+    EXPECT_EQ(100, settler.timeout(start));
+}
+
+TEST_F(Settler_test, immediate) {
+    Settler immediate{chrono::milliseconds(0)};
+    immediate.event(start);
+    EXPECT_EQ(0, immediate.timeout(start));
+}
+
+TEST_F(Settler_test, negative) {
+    EXPECT_THROW(Settler(chrono::milliseconds(-1)), invalid_argument);
+}
@@ -0,0 +1,247 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/calculations.h"
+#include "../src/layout.h"
+#include "../src/SnapshotBackend.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+class SnapshotBackend_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        edidHex = "00ffffffffffff00" + string(2 * EDID_MIN_LENGTH - 16, '0');
+        text = "# xlayoutdisplay snapshot\n"
+               "lid open\n"
+               "screen 1920 1080 8 8 16384 16384 508 286\n"
+               "primary 66\n"
+               "mode 72 1920 1080 148500000 2008 2052 2200 0 1084 1089 1125 5\n"
+               "mode 73 2560 1440 241500000 2608 2640 2720 0 1443 1448 1481 5\n"
+               "crtc 63 0 0 1920 1080 72 1 15 1 66 2 66 67\n"
+               "crtc 64 0 0 0 0 0 1 15 0 2 66 67\n"
+               "output 66 DP-0 0 63 600 340 1 2 63 64 0 1 72\n"
+               "output 67 HDMI-0 0 0 700 390 2 2 63 64 0 2 72 73\n"
+               "output 68 DP-1 1 0 0 0 0 2 63 64 0 0\n"
+               "edid 66 " + edidHex + "\n";
+    }
+
+    string edidHex;
+    string text;
+};
+
+TEST_F(SnapshotBackend_test, discover) {
+    istringstream in(text);
+    SnapshotBackend backend(in);
+    EXPECT_FALSE(backend.laptopLidClosed());
+
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    ASSERT_EQ(3, outputs.size());
+
+    const shared_ptr<Output> &dp0 = outputs.front();
+    EXPECT_EQ("DP-0", dp0->name);
+    EXPECT_EQ(Output::active, dp0->state);
+    EXPECT_EQ(66, dp0->rrOutput);
+    EXPECT_EQ(63, dp0->crtc);
+    EXPECT_TRUE(dp0->currentPrimary);
+    EXPECT_EQ(1920, dp0->currentMode->width);
+    EXPECT_EQ(60, dp0->currentMode->refresh);
+    EXPECT_EQ(0, dp0->currentPos->x);
+    ASSERT_TRUE(dp0->edid);
+    EXPECT_EQ(EDID_MIN_LENGTH, dp0->edid->length);
+
+    const shared_ptr<Output> &hdmi0 = *next(outputs.begin());
+    EXPECT_EQ("HDMI-0", hdmi0->name);
+    EXPECT_EQ(Output::connected, hdmi0->state);
+    EXPECT_FALSE(hdmi0->currentPrimary);
+    EXPECT_EQ(2560, hdmi0->preferredMode->width);
+    EXPECT_EQ(60, hdmi0->preferredMode->refresh);
+    EXPECT_NE(hdmi0->modes.end(), find(hdmi0->modes.begin(), hdmi0->modes.end(), dp0->currentMode));
+    EXPECT_FALSE(hdmi0->edid);
+
+    const shared_ptr<Output> &dp1 = outputs.back();
+    EXPECT_EQ(Output::disconnected, dp1->state);
+    EXPECT_FALSE(dp1->edid);
+}
+
+TEST_F(SnapshotBackend_test, write) {
+    istringstream in(text);
+    const SnapshotBackend backend(in);
+
+    ostringstream out;
+    backend.write(out);
+    EXPECT_EQ(text, out.str());
+}
+
+TEST_F(SnapshotBackend_test, apply) {
+    istringstream in(text);
+    SnapshotBackend backend(in);
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    const shared_ptr<Output> primary = activateOutputs(outputs, "HDMI-0", Monitors(false));
+    ltrOutputs(outputs);
+    assignCrtcs(outputs);
+
+    backend.apply(outputs, primary, 96, 0);
+
+    ostringstream out;
+    backend.write(out);
+    EXPECT_NE(string::npos, out.str().find("screen 4480 1440 "));
+    EXPECT_NE(string::npos, out.str().find("primary 67\n"));
+
+    const list<shared_ptr<Output>> applied = backend.rediscover(outputs, {67}, &explaination);
+    EXPECT_EQ("rediscovered 1 of 3 outputs", explaination.substr(0, 27));
+    ASSERT_EQ(3, applied.size());
+    EXPECT_EQ(outputs.front(), applied.front());
+    EXPECT_FALSE(applied.front()->desiredActive);
+    EXPECT_FALSE(applied.front()->currentPrimary);
+
+    const shared_ptr<Output> &hdmi0 = *next(applied.begin());
+    EXPECT_EQ(Output::active, hdmi0->state);
+    EXPECT_EQ(64, hdmi0->crtc);
+    EXPECT_EQ(2560, hdmi0->currentMode->width);
+    EXPECT_EQ(1920, hdmi0->currentPos->x);
+    EXPECT_TRUE(hdmi0->currentPrimary);
+}
+
+TEST_F(SnapshotBackend_test, applyCloneOff) {
+    const string cloned = "# xlayoutdisplay snapshot\n"
+                          "lid open\n"
+                          "screen 1920 1080 8 8 16384 16384 508 286\n"
+                          "primary 66\n"
+                          "mode 72 1920 1080 148500000 2008 2052 2200 0 1084 1089 1125 5\n"
+                          "crtc 63 0 0 1920 1080 72 1 15 2 66 67 2 66 67\n"
+                          "crtc 64 0 0 0 0 0 1 15 0 2 66 67\n"
+                          "output 66 DP-0 0 63 600 340 1 2 63 64 1 67 1 72\n"
+                          "output 67 HDMI-0 0 63 700 390 1 2 63 64 1 66 1 72\n";
+    istringstream in(cloned);
+    SnapshotBackend backend(in);
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+
+    // DP-0 as it is, HDMI-0 off
+    const shared_ptr<Output> &dp0 = outputs.front();
+    dp0->desiredActive = true;
+    dp0->desiredMode = dp0->currentMode;
+    dp0->desiredPos = dp0->currentPos;
+    dp0->desiredCrtc = dp0->crtc;
+
+    backend.apply(outputs, dp0, 96, 0);
+
+    ostringstream out;
+    backend.write(out);
+    EXPECT_NE(string::npos, out.str().find("crtc 63 0 0 1920 1080 72 1 15 1 66 2 66 67\n"));
+    EXPECT_NE(string::npos, out.str().find("output 66 DP-0 0 63 "));
+    EXPECT_NE(string::npos, out.str().find("output 67 HDMI-0 0 0 "));
+}
+
+TEST_F(SnapshotBackend_test, applyScaled) {
+    istringstream in(text);
+    SnapshotBackend backend(in);
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    const shared_ptr<Output> primary = activateOutputs(outputs, "DP-0", Monitors(false));
+    scaleMirrorOutputs(outputs, primary, true);
+    assignCrtcs(outputs);
+
+    backend.apply(outputs, primary, 96, 0);
+
+    ostringstream out;
+    backend.write(out);
+    EXPECT_NE(string::npos, out.str().find("screen 2560 1440 "));
+    EXPECT_NE(string::npos, out.str().find("crtc 63 0 0 2560 1440 72 "));
+
+    const list<shared_ptr<Output>> applied = backend.rediscover(outputs, {66, 67}, &explaination);
+    EXPECT_EQ(make_pair(2560u, 1440u), applied.front()->currentScaleFrom);
+    EXPECT_EQ(make_pair(0u, 0u), (*next(applied.begin()))->currentScaleFrom);
+
+    // laying out again changes nothing
+    scaleMirrorOutputs(applied, activateOutputs(applied, "DP-0", Monitors(false)), true);
+    assignCrtcs(applied);
+    for (const auto &output : applied)
+        EXPECT_EQ(Output::unchanged, calculateChange(output, 0)) << output->name;
+}
+
+TEST_F(SnapshotBackend_test, applyTooLarge) {
+    text.replace(text.find("16384 16384"), 11, "2000 2000");
+    istringstream in(text);
+    SnapshotBackend backend(in);
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    const shared_ptr<Output> primary = activateOutputs(outputs, "", Monitors(false));
+    ltrOutputs(outputs);
+    assignCrtcs(outputs);
+
+    EXPECT_THROW(backend.apply(outputs, primary, 96, 0), runtime_error);
+}
+
+TEST_F(SnapshotBackend_test, applyDpi) {
+    istringstream in(text);
+    SnapshotBackend backend(in);
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    const shared_ptr<Output> &dp0 = outputs.front();
+    dp0->desiredActive = true;
+    dp0->desiredMode = dp0->currentMode;
+    dp0->desiredPos = dp0->currentPos;
+    assignCrtcs(outputs);
+    ASSERT_TRUE(Changes(outputs, dp0, 0, false).none());
+    EXPECT_EQ(make_pair(508u, 286u), backend.screenMm());
+    EXPECT_FALSE(screenMmDiffers(backend.screenMm(), calculateScreenMm(backend.screenSize(), 96)));
+
+    // only the physical size changes
+    backend.apply(outputs, dp0, 192, 0);
+    EXPECT_EQ(make_pair(1920u, 1080u), backend.screenSize());
+    EXPECT_EQ(make_pair(254u, 142u), backend.screenMm());
+}
+
+TEST_F(SnapshotBackend_test, screenWithoutMm) {
+    text.replace(text.find(" 508 286"), 8, "");
+    istringstream in(text);
+    const SnapshotBackend backend(in);
+
+    EXPECT_EQ(make_pair(1920u, 1080u), backend.screenSize());
+    EXPECT_EQ(make_pair(0u, 0u), backend.screenMm());
+}
+
+TEST_F(SnapshotBackend_test, applyXftDpi) {
+    istringstream in(text);
+    SnapshotBackend backend(in);
+
+    EXPECT_TRUE(backend.applyXftDpi(96));
+    EXPECT_FALSE(backend.applyXftDpi(96));
+    EXPECT_EQ("Xft.dpi:\t96\n", backend.resources());
+}
+
+TEST_F(SnapshotBackend_test, malformed) {
+    for (const char *bad : {"mode 72 1920\n", "lid ajar\n", "primary 66 67\n", "monitor 1\n",
+                              "output 1 DP-2 0 0 0 0 0 2 63\n", "edid 99 00\n", "edid 66 0g\n", "edid 66 00ff\n"}) {
+        istringstream in(text + bad);
+        EXPECT_THROW(SnapshotBackend backend(in), invalid_argument) << bad;
+    }
+}
+
+TEST(SnapshotBackend_settings, nocache) {
+    Options options = settingsOptions();
+    const char *argv[] = {"xlayoutdisplay", "--snapshot", "recorded"};
+    options.parse(3, argv);
+
+    EXPECT_TRUE(Settings(options).nocache);
+}
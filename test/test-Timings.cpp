@@ -0,0 +1,113 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Timings.h"
+
+using namespace std;
+
+TEST(Timings, none) {
+    Timings timings("");
+    {
+        const Timings::Phase phase = timings.phase("one");
+    }
+    timings.add("two", chrono::milliseconds(1));
+
+    EXPECT_EQ(Timings::none, timings.format);
+    EXPECT_EQ("", timings.render());
+}
+
+TEST(Timings, unknownFormat) {
+    EXPECT_THROW(Timings("xml"), invalid_argument);
+}
+
+TEST(Timings, text) {
+    Timings timings("text");
+    timings.add("discover", chrono::microseconds(1500));
+    timings.add("apply", chrono::milliseconds(20));
+    timings.add("discover", chrono::microseconds(250));
+
+    EXPECT_EQ("timings (ms):\n"
+              "  discover       1.750\n"
+              "  apply         20.000\n"
+              "  total         21.750", timings.render());
+}
+
+TEST(Timings, json) {
+    Timings timings("json");
+    timings.add("discover", chrono::microseconds(1500));
+    timings.add("apply", chrono::milliseconds(20));
+
+    EXPECT_EQ("{\"phases\": {\"discover\": 1.500, \"apply\": 20.000}, \"total\": 21.500}", timings.render());
+}
+
+TEST(Timings, phase) {
+    Timings timings("json");
+    Timings::Phase phase = timings.phase("one");
+    phase = timings.phase("two");
+    phase.stop();
+    phase.stop();
+    {
+        const Timings::Phase three = timings.phase("three");
+    }
+
+    const string rendered = timings.render();
+    EXPECT_LT(rendered.find("\"one\""), rendered.find("\"two\""));
+    EXPECT_LT(rendered.find("\"two\""), rendered.find("\"three\""));
+    EXPECT_EQ(rendered.rfind("\"two\""), rendered.find("\"two\""));
+}
+
+TEST(Timings, traffic) {
+    Timings timings("text");
+    XTraffic::Counts counted;
+    timings.countTraffic([&counted]() { return counted; });
+    {
+        const Timings::Phase phase = timings.phase("discover");
+        counted.requests = 12;
+        counted.roundTrips = 3;
+        counted.bytesSent = 480;
+        counted.bytesReceived = 9000;
+    }
+    XTraffic::Counts applied;
+    applied.requests = 5;
+    applied.roundTrips = 2;
+    applied.bytesSent = 200;
+    applied.bytesReceived = 100;
+    timings.add("apply", chrono::milliseconds(20), applied);
+
+    const string rendered = timings.render();
+    EXPECT_EQ(0, rendered.find("timings (ms) and X requests, round trips, bytes sent, bytes received:\n"
+                               "  discover"));
+    EXPECT_NE(string::npos, rendered.find("        12     3       480      9000\n"));
+    EXPECT_NE(string::npos, rendered.find("  apply         20.000         5     2       200       100\n"));
+    EXPECT_NE(string::npos, rendered.find("        17     5       680      9100"));
+}
+
+TEST(Timings, trafficJson) {
+    Timings timings("json");
+    timings.countTraffic([]() { return XTraffic::Counts(); });
+    XTraffic::Counts applied;
+    applied.requests = 5;
+    applied.roundTrips = 2;
+    applied.bytesSent = 200;
+    applied.bytesReceived = 100;
+    timings.add("apply", chrono::milliseconds(20), applied);
+
+    EXPECT_EQ("{\"phases\": {\"apply\": 20.000}, \"total\": 20.000, \"traffic\": {"
+              "\"apply\": {\"requests\": 5, \"roundTrips\": 2, \"bytesSent\": 200, \"bytesReceived\": 100}, "
+              "\"total\": {\"requests\": 5, \"roundTrips\": 2, \"bytesSent\": 200, \"bytesReceived\": 100}}}",
+              timings.render());
+}
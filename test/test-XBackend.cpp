@@ -0,0 +1,114 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/Edid.h"
+#include "../src/layout.h"
+#include "../src/XBackend.h"
+
+#include "test-FakeX.h"
+
+using namespace std;
+
+TEST(XBackend_traffic, roundTripsIndependentOfOutputs) {
+    Options options = settingsOptions();
+    const char *argv[] = {"xlayoutdisplay", "--quiet", "--nocache"};
+    options.parse(3, argv);
+    const Settings settings(options);
+
+    // noutput connected outputs with EDID, any of which may use any CRTC, the first being active
+    vector<unsigned long> roundTrips;
+    for (const uint32_t &noutput : {2u, 4u, 16u}) {
+        FakeX::State state;
+        state.maxWidth = 32767;
+        state.maxHeight = 32767;
+        state.primary = 1001;
+        state.modes = {{72, 1920, 1080, 148500000, 2200, 1125}};
+        vector<uint32_t> crtcIds, outputIds;
+        for (uint32_t i = 0; i < noutput; i++) {
+            crtcIds.push_back(2001 + i);
+            outputIds.push_back(1001 + i);
+        }
+        FakeX x(state);
+        const uint32_t edidAtom = x.atom(RR_PROPERTY_RANDR_EDID);
+        const string edid = string("\x00\xff\xff\xff\xff\xff\xff\x00", 8) + string(EDID_MIN_LENGTH - 8, '\0');
+        x.update([&](FakeX::State &s) {
+            for (uint32_t i = 0; i < noutput; i++) {
+                s.crtcs.push_back(i ? FakeX::Crtc{2001 + i, 0, 0, 0, 0, 0, {}, outputIds}
+                                    : FakeX::Crtc{2001, 0, 0, 1920, 1080, 72, {1001}, outputIds});
+                s.outputs.push_back({1001 + i, "DP-" + to_string(i), 0, i ? 0 : 2001u, 600, 340, 1, crtcIds, {},
+                                     {72}, {{edidAtom, {XCB_ATOM_INTEGER, 8, edid}}}});
+            }
+        });
+
+        XBackend backend(make_shared<Session>(x.display().c_str()));
+        Timings timings("");
+        string explaination;
+        const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+        EXPECT_EQ(0, layout(settings, backend, outputs, explaination, timings));
+
+        const XTraffic::Counts traffic = backend.traffic();
+        EXPECT_LT(3 * noutput, traffic.requests) << noutput;
+        roundTrips.push_back(traffic.roundTrips);
+
+        // laid out side by side
+        const FakeX::State laidOut = x.state();
+        for (uint32_t i = 0; i < noutput; i++) {
+            EXPECT_EQ(1920 * i, laidOut.crtcs[i].x) << noutput;
+            EXPECT_EQ(vector<uint32_t>({1001 + i}), laidOut.crtcs[i].outputs) << noutput;
+        }
+        EXPECT_EQ(1920 * noutput, laidOut.width);
+    }
+
+    EXPECT_EQ(roundTrips.front(), roundTrips[1]);
+    EXPECT_EQ(roundTrips.front(), roundTrips.back());
+    EXPECT_EQ(6, roundTrips.front());
+}
+
+TEST(XBackend_apply, cloneTurnedOff) {
+
+    // clones sharing a CRTC
+    FakeX::State state;
+    state.primary = 1001;
+    state.modes = {{72, 1920, 1080, 148500000, 2200, 1125}};
+    state.crtcs = {{2001, 0, 0, 1920, 1080, 72, {1001, 1002}, {1001, 1002}},
+                   {2002, 0, 0, 0, 0, 0, {}, {1001, 1002}}};
+    state.outputs = {{1001, "DP-0", 0, 2001, 600, 340, 1, {2001, 2002}, {1002}, {72}, {}},
+                     {1002, "HDMI-0", 0, 2001, 700, 390, 1, {2001, 2002}, {1001}, {72}, {}}};
+    FakeX x(state);
+
+    XBackend backend(make_shared<Session>(x.display().c_str()));
+    string explaination;
+    const list<shared_ptr<Output>> outputs = backend.discover(false, &explaination);
+    ASSERT_EQ(2, outputs.size());
+
+    // DP-0 as it is, HDMI-0 off
+    const shared_ptr<Output> &dp0 = outputs.front();
+    dp0->desiredActive = true;
+    dp0->desiredMode = dp0->currentMode;
+    dp0->desiredPos = dp0->currentPos;
+    dp0->desiredCrtc = dp0->crtc;
+
+    backend.apply(outputs, dp0, 96, 0);
+
+    // DP-0 remains lit on its CRTC, alone
+    const FakeX::State applied = x.state();
+    EXPECT_EQ(72, applied.crtcs[0].mode);
+    EXPECT_EQ(vector<uint32_t>({1001}), applied.crtcs[0].outputs);
+    EXPECT_EQ(2001, applied.outputs[0].crtc);
+    EXPECT_EQ(0, applied.outputs[1].crtc);
+    EXPECT_EQ(0, applied.crtcs[1].mode);
+}
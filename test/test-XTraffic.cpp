@@ -0,0 +1,107 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/XTraffic.h"
+
+using namespace std;
+
+TEST(XTraffic, none) {
+    const XTraffic traffic;
+
+    const XTraffic::Counts counts = traffic.counts();
+    EXPECT_EQ(0, counts.requests);
+    EXPECT_EQ(0, counts.roundTrips);
+    EXPECT_EQ(0, counts.bytesSent);
+    EXPECT_EQ(0, counts.bytesReceived);
+}
+
+TEST(XTraffic, pipelined) {
+    XTraffic traffic;
+
+    // three sent then awaited in any order
+    traffic.sentSequence(10);
+    traffic.sentSequence(11);
+    traffic.sentSequence(12);
+    traffic.awaitingSequence(11);
+    traffic.awaitingSequence(10);
+    traffic.awaitingSequence(12);
+    EXPECT_EQ(3, traffic.counts().requests);
+    EXPECT_EQ(1, traffic.counts().roundTrips);
+
+    // one sent after the wait costs another
+    traffic.sentSequence(13);
+    traffic.awaitingSequence(13);
+    traffic.awaitingSequence(13);
+    EXPECT_EQ(4, traffic.counts().requests);
+    EXPECT_EQ(2, traffic.counts().roundTrips);
+}
+
+TEST(XTraffic, unseenRequests) {
+    XTraffic traffic;
+
+    traffic.sentSequence(1);
+    traffic.sentSequence(5);
+    traffic.sentSequence(3);
+    EXPECT_EQ(5, traffic.counts().requests);
+
+    traffic.awaitingSequence(3);
+    traffic.awaitingSequence(5);
+    EXPECT_EQ(1, traffic.counts().roundTrips);
+}
+
+TEST(XTraffic, wrapped) {
+    XTraffic traffic;
+
+    traffic.sentSequence(0xfffffffe);
+    traffic.sentSequence(0xffffffff);
+    traffic.sentSequence(0);
+    traffic.sentSequence(1);
+    traffic.awaitingSequence(0xffffffff);
+    traffic.awaitingSequence(1);
+    EXPECT_EQ(4, traffic.counts().requests);
+    EXPECT_EQ(1, traffic.counts().roundTrips);
+
+    traffic.sentSequence(2);
+    traffic.awaitingSequence(2);
+    EXPECT_EQ(5, traffic.counts().requests);
+    EXPECT_EQ(2, traffic.counts().roundTrips);
+}
+
+TEST(XTraffic, counts) {
+    XTraffic::Counts a;
+    a.requests = 10;
+    a.roundTrips = 4;
+    a.bytesSent = 300;
+    a.bytesReceived = 2000;
+    XTraffic::Counts b;
+    b.requests = 3;
+    b.roundTrips = 1;
+    b.bytesSent = 100;
+    b.bytesReceived = 500;
+
+    XTraffic::Counts difference = a - b;
+    EXPECT_EQ(7, difference.requests);
+    EXPECT_EQ(3, difference.roundTrips);
+    EXPECT_EQ(200, difference.bytesSent);
+    EXPECT_EQ(1500, difference.bytesReceived);
+
+    difference += b;
+    EXPECT_EQ(10, difference.requests);
+    EXPECT_EQ(4, difference.roundTrips);
+    EXPECT_EQ(300, difference.bytesSent);
+    EXPECT_EQ(2000, difference.bytesReceived);
+}
@@ -18,6 +18,10 @@
 
 #include "../src/calculations.h"
 
+#include <iomanip>
+#include <sstream>
+
+#include "test-allocations.h"
 #include "test-MockEdid.h"
 #include "test-MockMonitors.h"
 
@@ -50,7 +54,8 @@ TEST(calculations_orderOutputs, reposition) {
                                                      shared_ptr<Edid>());
     outputs.push_back(output5);
 
-    list<shared_ptr<Output>> orderedOutputs = orderOutputs(outputs, {"FOUR", "THREE", "TWO"});
+    list<shared_ptr<Output>> orderedOutputs = outputs;
+    orderOutputs(orderedOutputs, {"FOUR", "THREE", "TWO"});
 
     EXPECT_EQ(output4, orderedOutputs.front());
     orderedOutputs.pop_front();
@@ -64,6 +69,45 @@ TEST(calculations_orderOutputs, reposition) {
 }
 
 
+TEST(calculations_orderOutputs, patterns) {
+    list<shared_ptr<Output>> outputs;
+    for (const auto &name : {"eDP-1", "DP-1-2", "HDMI-0", "DP-1-1", "DP-0"})
+        outputs.push_back(make_shared<Output>(name, Output::disconnected, list<shared_ptr<const Mode>>(),
+                                              shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                              shared_ptr<Edid>()));
+
+    orderOutputs(outputs, {"hdmi-0", "DP-1-*", "DP-1-2"});
+
+    vector<string> names;
+    for (const auto &output : outputs)
+        names.push_back(output->name);
+    EXPECT_EQ(vector<string>({"HDMI-0", "DP-1-2", "DP-1-1", "eDP-1", "DP-0"}), names);
+}
+
+TEST(calculations_orderOutputs, allocationsIndependentOfOutputs) {
+    const OutputOrder order({"DP-3", "HDMI-*", "DP-1"});
+
+    vector<size_t> allocated;
+    for (const int &noutput : {4, 16, 64}) {
+        list<shared_ptr<Output>> outputs;
+        for (int i = 0; i < noutput; i++)
+            outputs.push_back(make_shared<Output>("DP-" + to_string(i), Output::disconnected,
+                                                  list<shared_ptr<const Mode>>(), shared_ptr<Mode>(),
+                                                  shared_ptr<Mode>(), shared_ptr<Pos>(), shared_ptr<Edid>()));
+
+        const size_t before = allocations();
+        orderOutputs(outputs, order);
+        allocated.push_back(allocations() - before);
+
+        EXPECT_EQ("DP-3", outputs.front()->name);
+        EXPECT_EQ("DP-1", (*next(outputs.begin()))->name);
+    }
+
+    EXPECT_EQ(allocated.front(), allocated[1]);
+    EXPECT_EQ(allocated.front(), allocated.back());
+    EXPECT_EQ(1, allocated.front());
+}
+
 class calculations_activateOutputs : public ::testing::Test {
 protected:
     shared_ptr<Mode> mode = make_shared<Mode>(0, 0, 0, 0);
@@ -354,6 +398,106 @@ TEST(calculations_mirrorOutputs, noCommon) {
 }
 
 
+TEST(calculations_mirrorOutputs, bestRefreshEach) {
+
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Mode> large = make_shared<Mode>(1, 2560, 1440, 60);
+    shared_ptr<Mode> wide60 = make_shared<Mode>(2, 1920, 1080, 60);
+    shared_ptr<Mode> wide144 = make_shared<Mode>(3, 1920, 1080, 144);
+    shared_ptr<Mode> wide50 = make_shared<Mode>(4, 1920, 1080, 50);
+    shared_ptr<Mode> wide75 = make_shared<Mode>(5, 1920, 1080, 75);
+    shared_ptr<Mode> tall = make_shared<Mode>(6, 1280, 1024, 60);
+    shared_ptr<Mode> wide60Again = make_shared<Mode>(7, 1920, 1080, 60);
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::disconnected,
+                                                     list<shared_ptr<const Mode>>({wide60, large, tall, wide144}),
+                                                     shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                     shared_ptr<Edid>());
+    output1->desiredActive = true;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::disconnected,
+                                                     list<shared_ptr<const Mode>>({tall, wide75, wide50}),
+                                                     shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                     shared_ptr<Edid>());
+    output2->desiredActive = true;
+    outputs.push_back(output2);
+
+    shared_ptr<Output> output3 = make_shared<Output>("Three", Output::disconnected,
+                                                     list<shared_ptr<const Mode>>({wide60, tall, wide60Again}),
+                                                     shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                     shared_ptr<Edid>());
+    output3->desiredActive = true;
+    outputs.push_back(output3);
+
+    mirrorOutputs(outputs);
+
+    EXPECT_EQ(wide144, output1->desiredMode);
+    EXPECT_EQ(wide75, output2->desiredMode);
+    EXPECT_EQ(wide60Again, output3->desiredMode);
+    EXPECT_EQ(0, output3->desiredPos->x);
+    EXPECT_EQ(0, output3->desiredPos->y);
+}
+
+
+class calculations_scaleMirrorOutputs : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (const auto &output : outputs)
+            output->desiredActive = true;
+        off->desiredActive = false;
+    }
+
+    shared_ptr<Mode> uhd = make_shared<Mode>(1, 3840, 2160, 60);
+    shared_ptr<Mode> fhd = make_shared<Mode>(2, 1920, 1080, 60);
+    shared_ptr<Mode> xga = make_shared<Mode>(3, 1024, 768, 75);
+    shared_ptr<Output> panel = make_shared<Output>("Panel", Output::connected, list<shared_ptr<const Mode>>({fhd, uhd}),
+                                                   nullptr, uhd, nullptr, shared_ptr<Edid>());
+    shared_ptr<Output> projector = make_shared<Output>("Projector", Output::connected,
+                                                       list<shared_ptr<const Mode>>({xga}), nullptr, nullptr, nullptr,
+                                                       shared_ptr<Edid>());
+    shared_ptr<Output> same = make_shared<Output>("Same", Output::connected, list<shared_ptr<const Mode>>({xga}),
+                                                  nullptr, nullptr, nullptr, shared_ptr<Edid>());
+    shared_ptr<Output> off = make_shared<Output>("Off", Output::connected, list<shared_ptr<const Mode>>({fhd}),
+                                                 nullptr, nullptr, nullptr, shared_ptr<Edid>());
+    list<shared_ptr<Output>> outputs = {panel, projector, same, off};
+};
+
+TEST_F(calculations_scaleMirrorOutputs, primary) {
+    scaleMirrorOutputs(outputs, projector, false);
+
+    EXPECT_EQ(uhd, panel->desiredMode);
+    EXPECT_EQ(make_pair(1024u, 768u), panel->desiredScaleFrom);
+    EXPECT_EQ(0, panel->desiredPos->x);
+    EXPECT_EQ(0, panel->desiredPos->y);
+
+    EXPECT_EQ(xga, projector->desiredMode);
+    EXPECT_EQ(make_pair(0u, 0u), projector->desiredScaleFrom);
+    EXPECT_EQ(xga, same->desiredMode);
+    EXPECT_EQ(make_pair(0u, 0u), same->desiredScaleFrom);
+
+    EXPECT_FALSE(off->desiredMode);
+    EXPECT_EQ(make_pair(1024u, 768u), calculateScreenSize(outputs));
+}
+
+TEST_F(calculations_scaleMirrorOutputs, largest) {
+    scaleMirrorOutputs(outputs, projector, true);
+
+    EXPECT_EQ(uhd, panel->desiredMode);
+    EXPECT_EQ(make_pair(0u, 0u), panel->desiredScaleFrom);
+    EXPECT_EQ(xga, projector->desiredMode);
+    EXPECT_EQ(make_pair(3840u, 2160u), projector->desiredScaleFrom);
+    EXPECT_EQ(make_pair(3840u, 2160u), same->desiredScaleFrom);
+
+    EXPECT_EQ(make_pair(3840u, 2160u), calculateScreenSize(outputs));
+}
+
+TEST_F(calculations_scaleMirrorOutputs, noPrimary) {
+    EXPECT_THROW(scaleMirrorOutputs(outputs, shared_ptr<Output>(), false), invalid_argument);
+}
+
+
 TEST(calculations_renderUserInfo, renderAll) {
     shared_ptr<Mode> mode1 = make_shared<Mode>(1, 2, 3, 4);
     shared_ptr<Mode> mode2 = make_shared<Mode>(5, 6, 7, 8);
@@ -381,12 +525,16 @@ TEST(calculations_renderUserInfo, renderAll) {
                                                  mode2, mode3, pos, edid3);
     outputs.push_back(act);
 
+    stringstream fingerprint1, fingerprint3;
+    fingerprint1 << hex << setfill('0') << setw(16) << edid1->fingerprint();
+    fingerprint3 << hex << setfill('0') << setw(16) << edid3->fingerprint();
+
     const string expected = ""
-            "dis disconnected 15cm/16cm\n"
+            "dis disconnected 15cm/16cm edid:" + fingerprint1.str() + "\n"
             "con connected\n"
-            "   2x3 4Hz\n"
             "  !6x7 8Hz\n"
-            "act active 17cm/18cm 6x7+13+14 8Hz\n"
+            "   2x3 4Hz\n"
+            "act active 17cm/18cm edid:" + fingerprint3.str() + " 6x7+13+14 8Hz\n"
             " +!10x11 12Hz\n"
             "*  6x7 8Hz\n"
             "   2x3 4Hz\n"
@@ -497,4 +645,393 @@ TEST_F(calculations_calculateDpi, valid) {
 
     EXPECT_EQ(1, calculated);
     EXPECT_EQ(expectedExplaination.str(), explaination);
-}
\ No newline at end of file
+}
+
+class calculations_assignCrtcs : public ::testing::Test {
+protected:
+    shared_ptr<Mode> mode = make_shared<Mode>(0, 0, 0, 0);
+    shared_ptr<Pos> pos = make_shared<Pos>(0, 0);
+    list<shared_ptr<const Mode>> modes = {mode};
+};
+
+TEST_F(calculations_assignCrtcs, keepCurrentThenFirstFree) {
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output1->crtcs = {1, 2, 3};
+    output1->desiredActive = true;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::active, modes, mode, nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output2->crtc = 1;
+    output2->crtcs = {1, 2, 3};
+    output2->desiredActive = true;
+    outputs.push_back(output2);
+
+    shared_ptr<Output> output3 = make_shared<Output>("Three", Output::active, modes, mode, nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output3->crtc = 2;
+    output3->crtcs = {1, 2, 3};
+    outputs.push_back(output3);
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(2, output1->desiredCrtc);
+    EXPECT_EQ(1, output2->desiredCrtc);
+    EXPECT_EQ(0, output3->desiredCrtc);
+}
+
+TEST_F(calculations_assignCrtcs, noneFree) {
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::active, modes, mode, nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output1->crtc = 1;
+    output1->crtcs = {1};
+    output1->desiredActive = true;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output2->crtcs = {1};
+    output2->desiredActive = true;
+    outputs.push_back(output2);
+
+    EXPECT_THROW(assignCrtcs(outputs), runtime_error);
+}
+
+TEST_F(calculations_assignCrtcs, reassignFree) {
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output1->crtcs = {1, 2};
+    output1->desiredActive = true;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output2->crtcs = {1};
+    output2->desiredActive = true;
+    outputs.push_back(output2);
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(2, output1->desiredCrtc);
+    EXPECT_EQ(1, output2->desiredCrtc);
+}
+
+TEST_F(calculations_assignCrtcs, moveCurrentOnlyWhenNeeded) {
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::active, modes, mode, nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output1->crtc = 1;
+    output1->crtcs = {1, 2};
+    output1->desiredActive = true;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output2->crtcs = {1, 3};
+    output2->desiredActive = true;
+    outputs.push_back(output2);
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(1, output1->desiredCrtc);
+    EXPECT_EQ(3, output2->desiredCrtc);
+
+    output2->crtcs = {1};
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(2, output1->desiredCrtc);
+    EXPECT_EQ(1, output2->desiredCrtc);
+}
+
+TEST_F(calculations_assignCrtcs, shareWithClone) {
+    list<shared_ptr<Output>> outputs;
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output1->rrOutput = 11;
+    output1->crtcs = {1};
+    output1->clones = {12};
+    output1->desiredActive = true;
+    output1->desiredMode = mode;
+    output1->desiredPos = pos;
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output2->rrOutput = 12;
+    output2->crtcs = {1};
+    output2->clones = {11};
+    output2->desiredActive = true;
+    output2->desiredMode = mode;
+    output2->desiredPos = make_shared<Pos>(0, 0);
+    outputs.push_back(output2);
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(1, output1->desiredCrtc);
+    EXPECT_EQ(1, output2->desiredCrtc);
+
+    const vector<vector<shared_ptr<Output>>> groups = crtcGroups(outputs);
+    ASSERT_EQ(1, groups.size());
+    EXPECT_EQ(vector<shared_ptr<Output>>({output1, output2}), groups.front());
+
+    // clones must show the same content
+    output2->desiredPos = make_shared<Pos>(0, 1);
+    EXPECT_THROW(assignCrtcs(outputs), runtime_error);
+
+    // clones must be mutual
+    output2->desiredPos = pos;
+    output2->clones.clear();
+    EXPECT_THROW(assignCrtcs(outputs), runtime_error);
+}
+
+TEST_F(calculations_assignCrtcs, keepSharedWithClone) {
+    list<shared_ptr<Output>> outputs;
+
+    // clones already sharing CRTC 1, with CRTC 2 free
+    for (const RROutput &rrOutput : {11ul, 12ul}) {
+        shared_ptr<Output> output = make_shared<Output>(to_string(rrOutput), Output::active, modes, mode, nullptr, pos,
+                                                        shared_ptr<Edid>());
+        output->rrOutput = rrOutput;
+        output->crtc = 1;
+        output->crtcs = {1, 2};
+        output->clones = {rrOutput == 11 ? 12ul : 11ul};
+        output->desiredActive = true;
+        output->desiredMode = mode;
+        output->desiredPos = pos;
+        outputs.push_back(output);
+    }
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(1, outputs.front()->desiredCrtc);
+    EXPECT_EQ(1, outputs.back()->desiredCrtc);
+    EXPECT_EQ(0, Changes(outputs, shared_ptr<Output>(), 0, false).modesets);
+
+    // split when no longer showing the same content
+    outputs.back()->desiredPos = make_shared<Pos>(0, 1);
+
+    assignCrtcs(outputs);
+
+    EXPECT_EQ(1, outputs.front()->desiredCrtc);
+    EXPECT_EQ(2, outputs.back()->desiredCrtc);
+}
+
+TEST_F(calculations_assignCrtcs, allocationsIndependentOfOutputs) {
+    vector<size_t> allocated;
+    for (const unsigned long &noutput : {4ul, 16ul, 64ul}) {
+
+        // every other output keeping its CRTC, the rest matched to those remaining
+        list<shared_ptr<Output>> outputs;
+        for (unsigned long i = 0; i < noutput; i++) {
+            shared_ptr<Output> output = make_shared<Output>(to_string(i), Output::active, modes, mode, nullptr, pos,
+                                                            shared_ptr<Edid>());
+            output->rrOutput = 101 + i;
+            output->crtc = i % 2 ? 0 : 1 + i;
+            for (unsigned long crtc = 1; crtc <= noutput; crtc++)
+                output->crtcs.push_back(crtc);
+            output->desiredActive = true;
+            outputs.push_back(output);
+        }
+
+        const size_t before = allocations();
+        assignCrtcs(outputs);
+        allocated.push_back(allocations() - before);
+
+        EXPECT_EQ(1, outputs.front()->desiredCrtc);
+        EXPECT_EQ(2, (*next(outputs.begin()))->desiredCrtc);
+    }
+
+    EXPECT_EQ(allocated.front(), allocated[1]);
+    EXPECT_EQ(allocated.front(), allocated.back());
+    EXPECT_EQ(3, allocated.front());
+}
+
+TEST(calculations_crtcGroups, separate) {
+    list<shared_ptr<const Mode>> modes = {make_shared<Mode>(0, 0, 0, 0)};
+    list<shared_ptr<Output>> outputs;
+    for (const RRCrtc crtc : {2ul, 0ul, 1ul}) {
+        shared_ptr<Output> output = make_shared<Output>("", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                        shared_ptr<Edid>());
+        output->desiredActive = true;
+        output->desiredCrtc = crtc;
+        outputs.push_back(output);
+    }
+
+    const vector<vector<shared_ptr<Output>>> groups = crtcGroups(outputs);
+
+    ASSERT_EQ(2, groups.size());
+    EXPECT_EQ(vector<shared_ptr<Output>>({outputs.front()}), groups[0]);
+    EXPECT_EQ(vector<shared_ptr<Output>>({outputs.back()}), groups[1]);
+}
+
+
+TEST(calculations_calculateScreenSize, bounds) {
+    list<shared_ptr<Output>> outputs;
+    list<shared_ptr<const Mode>> modes = {make_shared<Mode>(0, 10, 20, 30), make_shared<Mode>(0, 50, 10, 70)};
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output1->desiredActive = true;
+    output1->desiredMode = modes.front();
+    output1->desiredPos = make_shared<Pos>(0, 0);
+    outputs.push_back(output1);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output2->desiredActive = true;
+    output2->desiredMode = modes.back();
+    output2->desiredPos = make_shared<Pos>(10, 5);
+    outputs.push_back(output2);
+
+    shared_ptr<Output> output3 = make_shared<Output>("Three", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output3->desiredMode = modes.back();
+    output3->desiredPos = make_shared<Pos>(1000, 1000);
+    outputs.push_back(output3);
+
+    EXPECT_EQ(make_pair(60u, 20u), calculateScreenSize(outputs));
+}
+
+TEST(calculations_calculateScreenMm, dpi) {
+    EXPECT_EQ(make_pair(508u, 285u), calculateScreenMm(make_pair(1920u, 1080u), 96));
+    EXPECT_EQ(make_pair(254u, 142u), calculateScreenMm(make_pair(1920u, 1080u), 192));
+}
+
+TEST(calculations_screenMmDiffers, rounding) {
+
+    // 1080 at 96 DPI as rounded by the X server and as truncated by xrandr
+    EXPECT_FALSE(screenMmDiffers(make_pair(508u, 286u), calculateScreenMm(make_pair(1920u, 1080u), 96)));
+    EXPECT_FALSE(screenMmDiffers(make_pair(508u, 285u), calculateScreenMm(make_pair(1920u, 1080u), 96)));
+
+    EXPECT_TRUE(screenMmDiffers(make_pair(508u, 287u), make_pair(508u, 285u)));
+    EXPECT_TRUE(screenMmDiffers(make_pair(254u, 142u), calculateScreenMm(make_pair(1920u, 1080u), 96)));
+}
+
+
+class calculations_calculateRateMode : public ::testing::Test {
+protected:
+    shared_ptr<Mode> mode60 = make_shared<Mode>(1, 10, 20, 60);
+    shared_ptr<Mode> mode144 = make_shared<Mode>(2, 10, 20, 144);
+    shared_ptr<Mode> modeOther = make_shared<Mode>(3, 30, 40, 120);
+    shared_ptr<Output> output = make_shared<Output>("One", Output::connected,
+                                                    list<shared_ptr<const Mode>>({mode60, mode144, modeOther}),
+                                                    nullptr, nullptr, nullptr, shared_ptr<Edid>());
+};
+
+TEST_F(calculations_calculateRateMode, closest) {
+    output->desiredMode = mode144;
+
+    EXPECT_EQ(mode60, calculateRateMode(output, 50));
+    EXPECT_EQ(mode60, calculateRateMode(output, 100));
+    EXPECT_EQ(mode144, calculateRateMode(output, 120));
+}
+
+TEST_F(calculations_calculateRateMode, noDesiredMode) {
+    EXPECT_THROW(calculateRateMode(output, 60), invalid_argument);
+}
+
+class calculations_calculateChange : public ::testing::Test {
+protected:
+    void SetUp() override {
+        output->crtc = 1;
+        output->desiredCrtc = 1;
+        output->desiredActive = true;
+        output->desiredMode = mode60;
+        output->desiredPos = pos;
+    }
+
+    shared_ptr<Mode> mode60 = make_shared<Mode>(1, 10, 20, 60);
+    shared_ptr<Mode> mode144 = make_shared<Mode>(2, 10, 20, 144);
+    shared_ptr<Mode> modeOther = make_shared<Mode>(3, 30, 40, 120);
+    shared_ptr<Pos> pos = make_shared<Pos>(0, 0);
+    shared_ptr<Output> output = make_shared<Output>("One", Output::active,
+                                                    list<shared_ptr<const Mode>>({mode60, mode144, modeOther}),
+                                                    mode60, nullptr, pos, shared_ptr<Edid>());
+};
+
+TEST_F(calculations_calculateChange, unchanged) {
+    EXPECT_EQ(Output::unchanged, calculateChange(output, 0));
+
+    output->desiredMode = make_shared<Mode>(1, 10, 20, 60);
+    output->desiredPos = make_shared<Pos>(0, 0);
+    EXPECT_EQ(Output::unchanged, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, reposition) {
+    output->desiredPos = make_shared<Pos>(10, 0);
+    EXPECT_EQ(Output::reposition, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, modeset) {
+    output->desiredMode = modeOther;
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+
+    output->desiredMode = mode60;
+    output->desiredCrtc = 2;
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, modesetSameResolutionAndRefresh) {
+    // e.g. other timings or interlaced
+    output->desiredMode = make_shared<Mode>(9, 10, 20, 60);
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, scale) {
+    output->desiredScaleFrom = make_pair(30u, 40u);
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+
+    output->currentScaleFrom = make_pair(30u, 40u);
+    EXPECT_EQ(Output::unchanged, calculateChange(output, 0));
+
+    output->desiredScaleFrom = make_pair(0u, 0u);
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, rate) {
+    EXPECT_EQ(Output::unchanged, calculateChange(output, 50));
+    EXPECT_EQ(Output::modeset, calculateChange(output, 120));
+}
+
+TEST_F(calculations_calculateChange, disable) {
+    output->desiredActive = false;
+    EXPECT_EQ(Output::disable, calculateChange(output, 0));
+
+    output->crtc = 0;
+    EXPECT_EQ(Output::unchanged, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, enable) {
+    output->crtc = 0;
+    EXPECT_EQ(Output::modeset, calculateChange(output, 0));
+}
+
+TEST_F(calculations_calculateChange, changes) {
+    EXPECT_EQ("no changes", renderChanges(Changes({output}, shared_ptr<Output>(), 0, false)));
+
+    output->currentPrimary = true;
+    EXPECT_TRUE(Changes({output}, output, 0, false).none());
+
+    output->currentPrimary = false;
+    output->desiredPos = make_shared<Pos>(10, 0);
+    const Changes changes({output}, output, 0, false);
+    EXPECT_FALSE(changes.none());
+    EXPECT_EQ(1, changes.repositions);
+    EXPECT_EQ("0 modesets, 1 reposition, 0 disables, primary change", renderChanges(changes));
+}
+
+TEST_F(calculations_calculateChange, changesDpiOnly) {
+    const Changes changes({output}, shared_ptr<Output>(), 0, true);
+    EXPECT_FALSE(changes.none());
+    EXPECT_EQ("0 modesets, 0 repositions, 0 disables, DPI change", renderChanges(changes));
+}
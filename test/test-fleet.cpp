@@ -0,0 +1,89 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/fleet.h"
+
+#include "test-FakeX.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+
+TEST(fleet_localDisplays, sockets) {
+    char dir[] = "/tmp/test-fleet.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir));
+    for (const auto &name : {"X12", "X0", "X1", "Xa", "X", "x2", ".X3-lock"})
+        ofstream(string(dir) + "/" + name).put('\n');
+
+    EXPECT_EQ(vector<string>({":0", ":1", ":12"}), localDisplays(dir));
+
+    for (const auto &name : {"X12", "X0", "X1", "Xa", "X", "x2", ".X3-lock"})
+        remove((string(dir) + "/" + name).c_str());
+    rmdir(dir);
+}
+
+TEST(fleet_localDisplays, noDir) {
+    EXPECT_TRUE(localDisplays("/nonexistent/test-fleet").empty());
+}
+
+TEST(fleet_layoutFleet, failuresInOrder) {
+    Options options = settingsOptions();
+    const char *argv[] = {"xlayoutdisplay", "--quiet", "--nocache"};
+    options.parse(3, argv);
+    const Settings settings(options);
+    const vector<string> displays = {"unix:65531", "unix:65532", "unix:65533"};
+
+    const vector<FleetResult> results = layoutFleet(settings, displays, 2);
+
+    ASSERT_EQ(3, results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(displays[i], results[i].display);
+        EXPECT_EQ(EXIT_FAILURE, results[i].rc);
+        EXPECT_EQ("unable to open display '" + displays[i] + "'", results[i].error);
+    }
+}
+
+TEST(fleet_layoutFleet, connectionLost) {
+    Options options = settingsOptions();
+    const char *argv[] = {"xlayoutdisplay", "--quiet", "--nocache"};
+    options.parse(3, argv);
+    const Settings settings(options);
+
+    // one active output
+    FakeX::State state;
+    state.primary = 1001;
+    state.modes = {{72, 1920, 1080, 148500000, 2200, 1125}};
+    state.crtcs = {{2001, 0, 0, 1920, 1080, 72, {1001}, {1001}}};
+    state.outputs = {{1001, "DP-0", 0, 2001, 600, 340, 1, {2001}, {}, {72}, {}}};
+    FakeX up(state);
+    FakeX lost(state);
+    lost.disconnectAt(10);
+
+    const vector<FleetResult> results = layoutFleet(settings, {lost.display(), up.display()}, 2);
+
+    ASSERT_EQ(2, results.size());
+    EXPECT_EQ(EXIT_FAILURE, results[0].rc);
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_EQ(EXIT_SUCCESS, results[1].rc) << results[1].error;
+
+    // gone before answering its tenth request
+    EXPECT_EQ(9, lost.requests());
+}
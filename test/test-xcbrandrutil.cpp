@@ -0,0 +1,104 @@
+/*
+   Copyright 2018 Alexander Courtis
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "../src/xcbrandrutil.h"
+#include "../src/xrandrrutil.h"
+
+#include "test-FakeX.h"
+
+using namespace std;
+
+TEST(xcbrandrutil_modeInfoFromXcb, convert) {
+    xcb_randr_mode_info_t xcbModeInfo{};
+    xcbModeInfo.id = 1;
+    xcbModeInfo.width = 2;
+    xcbModeInfo.height = 3;
+    xcbModeInfo.dot_clock = 1000;
+    xcbModeInfo.htotal = 10;
+    xcbModeInfo.vtotal = 20;
+    xcbModeInfo.name_len = 4;
+    xcbModeInfo.mode_flags = XCB_RANDR_MODE_FLAG_DOUBLE_SCAN;
+
+    const XRRModeInfo modeInfo = modeInfoFromXcb(xcbModeInfo);
+
+    EXPECT_EQ(1, modeInfo.id);
+    EXPECT_EQ(2, modeInfo.width);
+    EXPECT_EQ(3, modeInfo.height);
+    EXPECT_EQ(1000, modeInfo.dotClock);
+    EXPECT_EQ(10, modeInfo.hTotal);
+    EXPECT_EQ(20, modeInfo.vTotal);
+    EXPECT_EQ(4, modeInfo.nameLength);
+    EXPECT_EQ(nullptr, modeInfo.name);
+    EXPECT_EQ(RR_DoubleScan, modeInfo.modeFlags);
+    EXPECT_EQ(3, refreshFromModeInfo(modeInfo));
+}
+
+TEST(xcbrandrutil_edidPropertyName, match) {
+    EXPECT_TRUE(edidPropertyName(RR_PROPERTY_RANDR_EDID));
+    EXPECT_TRUE(edidPropertyName("EDID_DATA"));
+    EXPECT_TRUE(edidPropertyName("EdidData"));
+    EXPECT_FALSE(edidPropertyName(RR_PROPERTY_BACKLIGHT));
+    EXPECT_FALSE(edidPropertyName(""));
+}
+
+TEST(xcbrandrutil_lazyEdid, extensionBlocks) {
+    string edid(4 * EDID_BLOCK_LENGTH, '\0');
+    edid[EDID_BYTE_EXTENSIONS] = 3;
+
+    FakeX::State state;
+    state.outputs = {{20, "DP-1", 0, 0, 600, 340, 0, {}, {}, {}, {}}};
+    FakeX x(state);
+    const uint32_t edidAtom = x.atom(RR_PROPERTY_RANDR_EDID);
+    x.update([&edid, &edidAtom](FakeX::State &s) { s.outputs[0].properties[edidAtom] = {19, 8, edid}; });
+
+    const shared_ptr<Session> session = make_shared<Session>(x.display().c_str());
+    const Lazy<const Edid> lazy = lazyEdid(make_shared<EdidBatch>(session, edidAtom), 20, "DP-1");
+    ASSERT_TRUE(lazy);
+    EXPECT_EQ(edid.size(), lazy->length);
+}
+
+TEST(xcbrandrutil_lazyEdid, fallbackBatched) {
+    FakeX::State state;
+    for (uint32_t id = 20; id < 24; id++)
+        state.outputs.push_back({id, "DP-" + to_string(id), 0, 0, 600, 340, 0, {}, {}, {}, {}});
+    FakeX x(state);
+    const uint32_t edidAtom = x.atom(RR_PROPERTY_RANDR_EDID);
+    const uint32_t legacyAtom = x.atom("EdidData");
+    x.update([&edidAtom, &legacyAtom](FakeX::State &s) {
+        s.outputs[0].properties[edidAtom] = {19, 8, string(EDID_MIN_LENGTH, '\1')};
+        for (size_t i = 1; i < s.outputs.size(); i++)
+            s.outputs[i].properties[legacyAtom] = {19, 8, string(EDID_MIN_LENGTH, (char) i)};
+    });
+
+    const shared_ptr<Session> session = make_shared<Session>(x.display().c_str());
+    const shared_ptr<EdidBatch> batch = make_shared<EdidBatch>(session, edidAtom);
+    vector<Lazy<const Edid>> edids;
+    for (uint32_t id = 20; id < 24; id++)
+        edids.push_back(lazyEdid(batch, id, "DP-" + to_string(id)));
+    for (const auto &edid : edids)
+        edid.request();
+
+    // the EDID replies, then the property lists, their names and the fallbacks, once each for all outputs
+    const XTraffic::Counts before = session->traffic.counts();
+    ASSERT_TRUE(edids[0]);
+    EXPECT_EQ(4, (session->traffic.counts() - before).roundTrips);
+    for (size_t i = 0; i < edids.size(); i++) {
+        ASSERT_TRUE(edids[i]);
+        EXPECT_EQ(i ? i : 1, edids[i]->data()[0]);
+    }
+    EXPECT_EQ(4, (session->traffic.counts() - before).roundTrips);
+}
@@ -18,10 +18,12 @@
 
 #include "../src/xrandrrutil.h"
 
+#include "test-FakeX.h"
 #include "test-MockEdid.h"
 
 using namespace std;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 using ::testing::Return;
 
 TEST(xrandrutil_renderXrandrCmd, renderAll) {
@@ -73,7 +75,50 @@ TEST(xrandrutil_renderXrandrCmd, renderAll) {
     expected << " --output Four --off \\\n";
     expected << " --output Five --mode 8x9 --rate 10 --pos 11x12";
 
-    EXPECT_EQ(expected.str(), renderXrandrCmd(outputs, output2, 123));
+    EXPECT_EQ(expected.str(), renderXrandrCmd(outputs, output2, 123, 0));
+}
+
+TEST(xrandrutil_renderXrandrCmd, scaled) {
+    shared_ptr<Mode> mode = make_shared<Mode>(0, 1024, 768, 60);
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::disconnected, list<shared_ptr<const Mode>>({mode}),
+                                                     shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                     shared_ptr<Edid>());
+    output1->desiredActive = true;
+    output1->desiredMode = mode;
+    output1->desiredPos = make_shared<Pos>(0, 0);
+    output1->desiredScaleFrom = make_pair(1920u, 1080u);
+
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::disconnected, list<shared_ptr<const Mode>>({mode}),
+                                                     shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                     shared_ptr<Edid>());
+    output2->desiredActive = true;
+    output2->desiredMode = mode;
+    output2->desiredPos = make_shared<Pos>(0, 0);
+    output2->currentScaleFrom = make_pair(1920u, 1080u);
+
+    EXPECT_EQ("xrandr \\\n"
+              " --dpi 96 \\\n"
+              " --output One --mode 1024x768 --rate 60 --pos 0x0 --scale-from 1920x1080 \\\n"
+              " --output Two --mode 1024x768 --rate 60 --pos 0x0 --transform none",
+              renderXrandrCmd({output1, output2}, shared_ptr<Output>(), 96, 0));
+}
+
+TEST(xrandrutil_renderXrandrCmd, crtc) {
+    shared_ptr<Mode> mode = make_shared<Mode>(0, 1024, 768, 60);
+
+    shared_ptr<Output> output = make_shared<Output>("One", Output::disconnected, list<shared_ptr<const Mode>>({mode}),
+                                                    shared_ptr<Mode>(), shared_ptr<Mode>(), shared_ptr<Pos>(),
+                                                    shared_ptr<Edid>());
+    output->desiredActive = true;
+    output->desiredMode = mode;
+    output->desiredPos = make_shared<Pos>(0, 0);
+    output->desiredCrtc = 63;
+
+    EXPECT_EQ("xrandr \\\n"
+              " --dpi 96 \\\n"
+              " --output One --mode 1024x768 --rate 60 --pos 0x0 --crtc 0x3f",
+              renderXrandrCmd({output}, shared_ptr<Output>(), 96, 0));
 }
 
 class xrandrutil_modeFromXRR : public ::testing::Test {
@@ -111,3 +156,221 @@ TEST_F(xrandrutil_modeFromXRR, resourcesNotPresent) {
     EXPECT_THROW(modeFromXRR(11, nullptr), invalid_argument);
 }
 
+class xrandrutil_outputFromXRR : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        resources.nmode = 3;
+        resources.modes = &modeInfos[0];
+
+        modeInfos[0].id = 10;
+        modeInfos[0].width = 100;
+        modeInfos[1].id = 11;
+        modeInfos[1].width = 110;
+        modeInfos[2].id = 12;
+        modeInfos[2].width = 120;
+
+        outputInfo.name = name;
+        outputInfo.nmode = 2;
+        outputInfo.modes = &rrModes[0];
+        outputInfo.npreferred = 2;
+        outputInfo.ncrtc = 2;
+        outputInfo.crtcs = &crtcs[0];
+
+        crtcInfo.x = 13;
+        crtcInfo.y = 14;
+        crtcInfo.mode = 12;
+
+        modeIndex = unique_ptr<ModeIndex>(new ModeIndex(&resources));
+    }
+
+    char name[5] = "Name";
+    XRRScreenResources resources{};
+    XRRModeInfo modeInfos[3]{};
+    RRMode rrModes[2] = {12, 10};
+    RRCrtc crtcs[2] = {1, 2};
+    XRROutputInfo outputInfo{};
+    XRRCrtcInfo crtcInfo{};
+    unique_ptr<ModeIndex> modeIndex;
+};
+
+TEST_F(xrandrutil_outputFromXRR, active) {
+    outputInfo.crtc = 1;
+
+    const shared_ptr<Output> output = outputFromXRR(*modeIndex, 7, &outputInfo, &crtcInfo, shared_ptr<Edid>());
+
+    EXPECT_EQ("Name", output->name);
+    EXPECT_EQ(Output::active, output->state);
+    ASSERT_EQ(2, output->modes.size());
+    EXPECT_EQ(120, output->modes.front()->width);
+    EXPECT_EQ(100, output->modes.back()->width);
+    EXPECT_EQ(output->modes.front(), output->currentMode);
+    EXPECT_EQ(output->modes.back(), output->preferredMode);
+    EXPECT_EQ(13, output->currentPos->x);
+    EXPECT_EQ(14, output->currentPos->y);
+    EXPECT_EQ(7, output->rrOutput);
+    EXPECT_EQ(1, output->crtc);
+    EXPECT_EQ(vector<RRCrtc>({1, 2}), output->crtcs);
+}
+
+TEST_F(xrandrutil_outputFromXRR, scaled) {
+    outputInfo.crtc = 1;
+
+    crtcInfo.width = 120;
+    crtcInfo.rotation = RR_Rotate_0;
+    const shared_ptr<Output> unscaled = outputFromXRR(*modeIndex, 7, &outputInfo, &crtcInfo, shared_ptr<Edid>());
+    EXPECT_EQ(make_pair(0u, 0u), unscaled->currentScaleFrom);
+
+    crtcInfo.width = 240;
+    crtcInfo.height = 10;
+    const shared_ptr<Output> scaled = outputFromXRR(*modeIndex, 7, &outputInfo, &crtcInfo, shared_ptr<Edid>());
+    EXPECT_EQ(make_pair(240u, 10u), scaled->currentScaleFrom);
+    EXPECT_EQ(make_pair(240u, 10u), scaled->currentArea());
+
+    crtcInfo.rotation = RR_Rotate_90;
+    const shared_ptr<Output> rotated = outputFromXRR(*modeIndex, 7, &outputInfo, &crtcInfo, shared_ptr<Edid>());
+    EXPECT_EQ(make_pair(0u, 0u), rotated->currentScaleFrom);
+}
+
+TEST_F(xrandrutil_outputFromXRR, connected) {
+    const shared_ptr<Output> output = outputFromXRR(*modeIndex, 7, &outputInfo, nullptr, shared_ptr<Edid>());
+
+    EXPECT_EQ(Output::connected, output->state);
+    EXPECT_EQ(2, output->modes.size());
+    EXPECT_FALSE(output->currentMode);
+    EXPECT_FALSE(output->currentPos);
+}
+
+TEST_F(xrandrutil_outputFromXRR, sharedModes) {
+    outputInfo.crtc = 1;
+
+    const shared_ptr<Output> active = outputFromXRR(*modeIndex, 7, &outputInfo, &crtcInfo, shared_ptr<Edid>());
+    outputInfo.crtc = 0;
+    const shared_ptr<Output> connected1 = outputFromXRR(*modeIndex, 7, &outputInfo, nullptr, shared_ptr<Edid>());
+    const shared_ptr<Output> connected2 = outputFromXRR(*modeIndex, 7, &outputInfo, nullptr, shared_ptr<Edid>());
+
+    // one Mode per RRMode used, regardless of the number of outputs
+    EXPECT_EQ(active->modes, connected1->modes);
+    EXPECT_EQ(active->modes, connected2->modes);
+    EXPECT_EQ(active->currentMode, connected1->modes.front());
+}
+
+TEST_F(xrandrutil_outputFromXRR, activeNoCrtcInfo) {
+    outputInfo.crtc = 1;
+
+    EXPECT_THROW(outputFromXRR(*modeIndex, 7, &outputInfo, nullptr, shared_ptr<Edid>()), invalid_argument);
+}
+
+TEST(xrandrutil_resourcesEmpty, empty) {
+    XRRModeInfo modeInfo{};
+    RROutput rrOutput = 1;
+
+    XRRScreenResources noOutputs{};
+    noOutputs.nmode = 1;
+    noOutputs.modes = &modeInfo;
+
+    XRRScreenResources noModes{};
+    noModes.noutput = 1;
+    noModes.outputs = &rrOutput;
+
+    EXPECT_TRUE(resourcesEmpty(nullptr));
+    EXPECT_TRUE(resourcesEmpty(&noOutputs));
+    EXPECT_TRUE(resourcesEmpty(&noModes));
+}
+
+TEST(xrandrutil_resourcesEmpty, current) {
+    XRRModeInfo modeInfo{};
+    RROutput rrOutput = 1;
+
+    XRRScreenResources resources{};
+    resources.nmode = 1;
+    resources.modes = &modeInfo;
+    resources.noutput = 1;
+    resources.outputs = &rrOutput;
+
+    EXPECT_FALSE(resourcesEmpty(&resources));
+}
+
+
+TEST(xrandrutil_changedOutputs, crtcs) {
+    list<shared_ptr<const Mode>> modes = {make_shared<Mode>(0, 0, 0, 0)};
+    shared_ptr<Pos> pos = make_shared<Pos>(0, 0);
+
+    shared_ptr<Output> output1 = make_shared<Output>("One", Output::active, modes, modes.front(), nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output1->rrOutput = 11;
+    output1->crtc = 21;
+    shared_ptr<Output> output2 = make_shared<Output>("Two", Output::active, modes, modes.front(), nullptr, pos,
+                                                     shared_ptr<Edid>());
+    output2->rrOutput = 12;
+    output2->crtc = 22;
+    shared_ptr<Output> output3 = make_shared<Output>("Three", Output::connected, modes, nullptr, nullptr, nullptr,
+                                                     shared_ptr<Edid>());
+    output3->rrOutput = 13;
+    const list<shared_ptr<Output>> previous = {output1, output2, output3};
+
+    EXPECT_EQ(set<RROutput>(), changedOutputs(previous, {}, {}));
+    EXPECT_EQ(set<RROutput>({13, 14}), changedOutputs(previous, {13, 14}, {}));
+    EXPECT_EQ(set<RROutput>({12, 13}), changedOutputs(previous, {13}, {22, 23}));
+}
+
+class xrandrutil_rediscoverOutputs : public ::testing::Test {
+protected:
+    static FakeX::State initial() {
+        FakeX::State state;
+        state.modes = {{1, 1920, 1080, 148500000, 2200, 1125}, {2, 1280, 720, 74250000, 1650, 750}};
+        state.crtcs = {{10, 0, 0, 1920, 1080, 1, {20}, {20, 21, 22}}, {11, 0, 0, 0, 0, 0, {}, {20, 21, 22}}};
+        state.outputs = {{20, "eDP-1", 0, 10, 344, 194, 1, {10, 11}, {}, {1, 2}, {}},
+                         {21, "HDMI-1", 1, 0, 0, 0, 0, {10, 11}, {}, {}, {}},
+                         {22, "DP-1", 1, 0, 0, 0, 0, {10, 11}, {}, {}, {}}};
+        state.primary = 20;
+        return state;
+    }
+
+    FakeX x{initial()};
+};
+
+TEST_F(xrandrutil_rediscoverOutputs, changedBetweenDiscoveries) {
+    const shared_ptr<Session> session = make_shared<Session>(x.display().c_str());
+    string explaination;
+
+    const list<shared_ptr<Output>> previous = discoverOutputs(session, false, &explaination);
+    ASSERT_EQ(3, previous.size());
+    const shared_ptr<Output> edp = previous.front();
+    EXPECT_EQ("eDP-1", edp->name);
+    EXPECT_EQ(Output::active, edp->state);
+    EXPECT_TRUE(edp->currentPrimary);
+    EXPECT_EQ(Output::disconnected, (*next(previous.begin()))->state);
+
+    // HDMI-1 is plugged in, DP-1 goes away and DP-2 arrives
+    edp->desiredActive = true;
+    x.update([](FakeX::State &state) {
+        state.outputs[1].connection = 0;
+        state.outputs[1].mmWidth = 600;
+        state.outputs[1].mmHeight = 340;
+        state.outputs[1].npreferred = 1;
+        state.outputs[1].modes = {1, 2};
+        state.outputs[2] = {23, "DP-2", 0, 0, 0, 0, 1, {11}, {}, {2}, {}};
+    });
+
+    const list<shared_ptr<Output>> outputs = rediscoverOutputs(session, previous, {21}, &explaination);
+    EXPECT_THAT(explaination, HasSubstr("rediscovered 2 of 3 outputs"));
+    ASSERT_EQ(3, outputs.size());
+
+    auto it = outputs.begin();
+    EXPECT_EQ(edp, *it);
+    EXPECT_FALSE(edp->desiredActive);
+    EXPECT_TRUE(edp->currentPrimary);
+
+    const shared_ptr<Output> hdmi = *++it;
+    EXPECT_EQ("HDMI-1", hdmi->name);
+    EXPECT_EQ(Output::connected, hdmi->state);
+    ASSERT_TRUE(hdmi->preferredMode);
+    EXPECT_EQ(1, hdmi->preferredMode->rrMode);
+    EXPECT_EQ(2, hdmi->modes.size());
+
+    const shared_ptr<Output> dp = *++it;
+    EXPECT_EQ("DP-2", dp->name);
+    EXPECT_EQ(23, dp->rrOutput);
+    EXPECT_EQ(Output::connected, dp->state);
+    EXPECT_EQ(vector<RRCrtc>({11}), dp->crtcs);
+}
@@ -22,3 +22,25 @@ using namespace std;
 TEST(xrdbutil_renderXrdbCmd, render) {
     EXPECT_EQ("echo \"Xft.dpi: 234\" | xrdb -merge", renderXrdbCmd(234));
 }
+
+TEST(xrdbutil_mergeXftDpi, empty) {
+    EXPECT_EQ("Xft.dpi:\t96\n", mergeXftDpi("", 96));
+}
+
+TEST(xrdbutil_mergeXftDpi, append) {
+    EXPECT_EQ("Xcursor.size:\t24\nXft.dpi:\t96\n", mergeXftDpi("Xcursor.size:\t24\n", 96));
+}
+
+TEST(xrdbutil_mergeXftDpi, replace) {
+    EXPECT_EQ("Xcursor.size:\t24\nXft.dpi:\t144\nXft.antialias:\t1\n",
+              mergeXftDpi("Xcursor.size:\t24\n  Xft.dpi :\t96\nXft.antialias:\t1\nXft.dpi:\t120\n", 144));
+}
+
+TEST(xrdbutil_mergeXftDpi, unchanged) {
+    const string resources = "Xcursor.size:\t24\nXft.dpi:\t96\n";
+    EXPECT_EQ(resources, mergeXftDpi(resources, 96));
+}
+
+TEST(xrdbutil_mergeXftDpi, otherResources) {
+    EXPECT_EQ("Xft.dpiScale:\t2\n*Xft.dpi:\t1\nXft.dpi:\t96\n", mergeXftDpi("Xft.dpiScale:\t2\n*Xft.dpi:\t1\n", 96));
+}